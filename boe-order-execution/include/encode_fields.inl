@@ -0,0 +1,14 @@
+#if !defined(LAYOUT) || !defined(ORDER)
+#  error You need to define LAYOUT and ORDER macro
+#else
+
+// response field tables expanded into encoding of ORDER members into the LAYOUT fields at start,
+// the tables undefine these, so this is included right before each of them
+
+#define FIELD(name, type) encode_##type(start + LAYOUT::offset<LAYOUT::name>, ORDER.name);
+#define VAR_FIELD(name, type, size) encode_##type(start + LAYOUT::offset<LAYOUT::name>, ORDER.name, size);
+#define OPT_FIELD(name, type) FIELD(name, type)
+#define OPT_VAR_FIELD(name, type, size) VAR_FIELD(name, type, size)
+#define RAW_FIELD(name, size)
+
+#endif
@@ -1,15 +1,32 @@
-#if !defined(FIELD) || !defined(VAR_FIELD) || !defined(OPT_FIELD) || !defined(OPT_VAR_FIELD)
-#  error You need to define FIELD, VAR_FIELD and OPT_FIELD macro
+#if !defined(FIELD) || !defined(VAR_FIELD) || !defined(OPT_FIELD) || !defined(OPT_VAR_FIELD) || !defined(RAW_FIELD)
+#  error You need to define FIELD, VAR_FIELD, OPT_FIELD, OPT_VAR_FIELD and RAW_FIELD macro
 #else
 
-VAR_FIELD(cl_ord_id, text, 18, 20)
-FIELD(exec_id, text36, 38)
-FIELD(filled_volume, binary4, 46)
-FIELD(price, price, 50)
-FIELD(active_volume, binary4, 58)
-FIELD(liquidity_indicator, liquidity_indicator, 62)
+RAW_FIELD(start_of_message, 2)
+RAW_FIELD(message_length, 2)
+RAW_FIELD(message_type, 1)
+RAW_FIELD(matching_unit, 1)
+RAW_FIELD(sequence_number, 4)
+RAW_FIELD(transaction_time, 8)
+VAR_FIELD(cl_ord_id, text, 20)
+FIELD(exec_id, text36)
+FIELD(filled_volume, binary4)
+FIELD(price, price)
+FIELD(active_volume, binary4)
+FIELD(liquidity_indicator, liquidity_indicator)
+RAW_FIELD(sub_liquidity_indicator, 1)
+RAW_FIELD(contra_broker, 4)
+RAW_FIELD(reserved, 1)
+RAW_FIELD(bitfield_count, 1)
+RAW_FIELD(bitfields, exec_order_bitfield_num())
 OPT_VAR_FIELD(symbol, text, 8)
 OPT_VAR_FIELD(last_mkt, text, 4)
 OPT_VAR_FIELD(fee_code, text, 2)
 
+#undef FIELD
+#undef VAR_FIELD
+#undef OPT_FIELD
+#undef OPT_VAR_FIELD
+#undef RAW_FIELD
+
 #endif
@@ -61,7 +61,7 @@ inline constexpr size_t text36_size = 8;
 #define VAR_FIELD(name, size) inline constexpr size_t name##_field_size = size;
 #include "fields.inl"
 
-inline void set_opt_field_bit(unsigned char * bitfield_start, unsigned bitfield_num, unsigned bit)
+constexpr void set_opt_field_bit(unsigned char * bitfield_start, unsigned bitfield_num, unsigned bit)
 {
     *(bitfield_start + bitfield_num - 1) |= bit;
 }
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "latency.h"
+
+#include <cstddef>
+
+/*
+ * Loopback exchange simulator
+ *  Single threaded epoll loop running both ends of a TCP loopback connection:
+ *  the client sends New Orders keeping up to window of them in flight, the
+ *  server answers every order with an Order Execution (and every
+ *  restatement_period-th one with an Order Restatement first), the client
+ *  decodes the responses and records round trip latency.
+ */
+struct GatewayStats
+{
+    size_t orders = 0;
+    size_t executions = 0;
+    size_t restatements = 0;
+    double filled_volume = 0;
+    double restated_volume = 0;
+    double seconds = 0;
+    latency::Histogram round_trip;
+};
+
+struct GatewayConfig
+{
+    size_t order_count = 1000000;
+    size_t window = 64;
+    size_t restatement_period = 10;
+};
+
+void run_gateway_simulation(const GatewayConfig & config, GatewayStats & stats);
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+/*
+ * Latency instrumentation
+ *  ticks() is rdtsc where available and steady_clock nanoseconds otherwise,
+ *  ticks_per_ns() calibrates ticks against steady_clock once per process.
+ *  Histogram keeps HDR-style log-linear buckets in a fixed array, so
+ *  recording never allocates.
+ */
+namespace latency {
+
+inline uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline double calibrate_ticks_per_ns()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    const auto calibration_time = std::chrono::milliseconds(20);
+    const auto clock_start = std::chrono::steady_clock::now();
+    const uint64_t ticks_start = ticks();
+    auto clock_end = clock_start;
+    while (clock_end - clock_start < calibration_time) {
+        clock_end = std::chrono::steady_clock::now();
+    }
+    const uint64_t ticks_end = ticks();
+    const auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start).count();
+    return static_cast<double>(ticks_end - ticks_start) / static_cast<double>(elapsed_ns);
+#else
+    return 1.0;
+#endif
+}
+
+inline double ticks_per_ns()
+{
+    static const double value = calibrate_ticks_per_ns();
+    return value;
+}
+
+class Histogram
+{
+public:
+    // every power of two range is split into 2^sub_bucket_bits buckets (~3% precision)
+    static constexpr unsigned sub_bucket_bits = 5;
+    static constexpr uint64_t sub_bucket_count = uint64_t{1} << sub_bucket_bits;
+    static constexpr size_t bucket_count = (65 - sub_bucket_bits) * sub_bucket_count;
+
+    void record(const uint64_t value)
+    {
+        ++m_buckets[bucket_index(value)];
+        ++m_count;
+        m_total += value;
+        m_min = value < m_min ? value : m_min;
+        m_max = value > m_max ? value : m_max;
+    }
+
+    void reset()
+    {
+        *this = Histogram();
+    }
+
+    uint64_t count() const { return m_count; }
+    uint64_t min() const { return m_count == 0 ? 0 : m_min; }
+    uint64_t max() const { return m_max; }
+    double mean() const { return m_count == 0 ? 0.0 : static_cast<double>(m_total) / static_cast<double>(m_count); }
+
+    // highest value equivalent to the requested percentile (0 - 100)
+    uint64_t percentile(const double p) const
+    {
+        if (m_count == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(m_count) + 0.5);
+        rank = rank == 0 ? 1 : (rank > m_count ? m_count : rank);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; ++i) {
+            seen += m_buckets[i];
+            if (seen >= rank) {
+                const uint64_t upper = bucket_upper_bound(i);
+                return upper < m_max ? upper : m_max;
+            }
+        }
+        return m_max;
+    }
+
+private:
+    static size_t bucket_index(const uint64_t value)
+    {
+        if (value < sub_bucket_count) {
+            return value;
+        }
+        const unsigned magnitude = 63 - __builtin_clzll(value);
+        const unsigned shift = magnitude - sub_bucket_bits;
+        return (shift + 1) * sub_bucket_count + ((value >> shift) - sub_bucket_count);
+    }
+
+    static uint64_t bucket_upper_bound(const size_t index)
+    {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+        const uint64_t level = index / sub_bucket_count - 1;
+        const uint64_t sub_bucket = index % sub_bucket_count;
+        return ((sub_bucket_count + sub_bucket + 1) << level) - 1;
+    }
+
+    std::array<uint64_t, bucket_count> m_buckets{};
+    uint64_t m_count = 0;
+    uint64_t m_total = 0;
+    uint64_t m_min = UINT64_MAX;
+    uint64_t m_max = 0;
+};
+
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Histogram & histogram)
+        : m_histogram(histogram)
+        , m_start(ticks())
+    {
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+    ~ScopedTimer()
+    {
+        m_histogram.record(ticks() - m_start);
+    }
+
+private:
+    Histogram & m_histogram;
+    const uint64_t m_start;
+};
+
+inline void print_percentiles(std::ostream & out, const char * name, const Histogram & histogram)
+{
+    const double scale = 1.0 / ticks_per_ns();
+    const auto ns = [scale](const uint64_t value) { return static_cast<double>(value) * scale; };
+    out << name << ": count " << histogram.count()
+        << ", min " << ns(histogram.min())
+        << " ns, mean " << histogram.mean() * scale
+        << " ns, p50 " << ns(histogram.percentile(50))
+        << " ns, p90 " << ns(histogram.percentile(90))
+        << " ns, p99 " << ns(histogram.percentile(99))
+        << " ns, p99.9 " << ns(histogram.percentile(99.9))
+        << " ns, p99.99 " << ns(histogram.percentile(99.99))
+        << " ns, max " << ns(histogram.max()) << " ns" << std::endl;
+}
+
+} // namespace latency
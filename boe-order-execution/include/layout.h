@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+/*
+ * Message layout
+ *  Every message is described by an X-macro table of consecutive fields,
+ *  field offsets and the total message size are computed at compile time
+ *  from the field sizes, so encoders and decoders work with constant offsets.
+ */
+template <size_t N>
+struct MessageLayout
+{
+    std::array<size_t, N> offsets;
+    size_t size;
+};
+
+template <size_t N>
+constexpr MessageLayout<N> make_layout(const size_t (&field_sizes)[N])
+{
+    MessageLayout<N> layout{};
+    for (size_t i = 0; i < N; ++i) {
+        layout.offsets[i] = layout.size;
+        layout.size += field_sizes[i];
+    }
+    return layout;
+}
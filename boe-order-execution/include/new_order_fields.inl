@@ -0,0 +1,19 @@
+#if !defined(FIELD) || !defined(RAW_FIELD)
+#  error You need to define FIELD and RAW_FIELD macro
+#else
+
+RAW_FIELD(start_of_message, 2)
+RAW_FIELD(message_length, 2)
+RAW_FIELD(message_type, 1)
+RAW_FIELD(matching_unit, 1)
+RAW_FIELD(sequence_number, 4)
+FIELD(cl_ord_id)
+FIELD(side)
+FIELD(order_qty)
+RAW_FIELD(bitfield_count, 1)
+RAW_FIELD(bitfields, new_order_bitfield_num())
+
+#undef FIELD
+#undef RAW_FIELD
+
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "fields.h"
+#include "layout.h"
 
 #include <algorithm>
 #include <array>
@@ -42,14 +43,119 @@ constexpr size_t rest_order_bitfield_num()
     });
 }
 
-constexpr size_t new_order_opt_fields_size()
+constexpr std::array<unsigned char, new_order_bitfield_num()> new_order_bitfields()
 {
-    return 0
-#define FIELD(name, _, __) +name##_field_size
+    std::array<unsigned char, new_order_bitfield_num()> result{};
+#define FIELD(_, n, bit) set_opt_field_bit(result.data(), n, bit);
 #include "new_order_opt_fields.inl"
-            ;
+    return result;
 }
 
+constexpr std::array<unsigned char, exec_order_bitfield_num()> exec_order_bitfields()
+{
+    std::array<unsigned char, exec_order_bitfield_num()> result{};
+#define FIELD(_, n, bit) set_opt_field_bit(result.data(), n, bit);
+#include "exec_order_opt_fields.inl"
+    return result;
+}
+
+constexpr std::array<unsigned char, rest_order_bitfield_num()> rest_order_bitfields()
+{
+    std::array<unsigned char, rest_order_bitfield_num()> result{};
+#define FIELD(_, n, bit) set_opt_field_bit(result.data(), n, bit);
+#include "rest_order_opt_fields.inl"
+    return result;
+}
+
+inline constexpr size_t liquidity_indicator_size = 1;
+inline constexpr size_t reason_size = 1;
+
+/*
+ * Message layouts
+ *  new_order::offset<new_order::price> etc. are compile time constants
+ */
+namespace new_order {
+
+enum Field : size_t
+{
+#define FIELD(name) name,
+#define RAW_FIELD(name, _) name,
+#include "new_order_fields.inl"
+#define FIELD(name, _, __) name,
+#include "new_order_opt_fields.inl"
+};
+
+inline constexpr size_t field_sizes[] = {
+#define FIELD(name) name##_field_size,
+#define RAW_FIELD(_, size) size,
+#include "new_order_fields.inl"
+#define FIELD(name, _, __) name##_field_size,
+#include "new_order_opt_fields.inl"
+};
+
+inline constexpr auto layout = make_layout(field_sizes);
+
+template <Field field>
+inline constexpr size_t offset = layout.offsets[field];
+
+} // namespace new_order
+
+namespace exec_order {
+
+enum Field : size_t
+{
+#define FIELD(name, _) name,
+#define VAR_FIELD(name, _, __) name,
+#define OPT_FIELD(name, _) name,
+#define OPT_VAR_FIELD(name, _, __) name,
+#define RAW_FIELD(name, _) name,
+#include "exec_order_fields.inl"
+};
+
+inline constexpr size_t field_sizes[] = {
+#define FIELD(_, type) type##_size,
+#define VAR_FIELD(_, __, size) size,
+#define OPT_FIELD(_, type) type##_size,
+#define OPT_VAR_FIELD(_, __, size) size,
+#define RAW_FIELD(_, size) size,
+#include "exec_order_fields.inl"
+};
+
+inline constexpr auto layout = make_layout(field_sizes);
+
+template <Field field>
+inline constexpr size_t offset = layout.offsets[field];
+
+} // namespace exec_order
+
+namespace rest_order {
+
+enum Field : size_t
+{
+#define FIELD(name, _) name,
+#define VAR_FIELD(name, _, __) name,
+#define OPT_FIELD(name, _) name,
+#define OPT_VAR_FIELD(name, _, __) name,
+#define RAW_FIELD(name, _) name,
+#include "rest_order_fields.inl"
+};
+
+inline constexpr size_t field_sizes[] = {
+#define FIELD(_, type) type##_size,
+#define VAR_FIELD(_, __, size) size,
+#define OPT_FIELD(_, type) type##_size,
+#define OPT_VAR_FIELD(_, __, size) size,
+#define RAW_FIELD(_, size) size,
+#include "rest_order_fields.inl"
+};
+
+inline constexpr auto layout = make_layout(field_sizes);
+
+template <Field field>
+inline constexpr size_t offset = layout.offsets[field];
+
+} // namespace rest_order
+
 enum class RequestType
 {
     New
@@ -59,8 +165,9 @@ constexpr size_t calculate_size(const RequestType type)
 {
     switch (type) {
     case RequestType::New:
-        return 36 + new_order_bitfield_num() + new_order_opt_fields_size();
+        return new_order::layout.size;
     }
+    return 0;
 }
 
 enum class Side
@@ -103,6 +210,28 @@ std::array<unsigned char, calculate_size(RequestType::New)> create_new_order_req
         Capacity capacity,
         const std::string & account);
 
+/*
+ * Returns false for message types other than New Order, used by the exchange simulator
+ */
+bool decode_request_type(unsigned const char * message, RequestType & type);
+
+/*
+ * Framing
+ *  Returns size of the message at the start of the buffer,
+ *  or 0 if the buffer doesn't hold a complete message yet
+ */
+inline size_t frame_size(unsigned const char * start, const size_t available)
+{
+    constexpr size_t length_offset = exec_order::offset<exec_order::message_length>;
+    constexpr size_t length_end = exec_order::offset<exec_order::message_type>;
+    if (available < length_end) {
+        return 0;
+    }
+    // message length counts every byte after the start of message marker
+    const size_t size = length_offset + (static_cast<size_t>(start[length_offset]) | (static_cast<size_t>(start[length_offset + 1]) << 8));
+    return size <= available ? size : 0;
+}
+
 /*
  * Inbound messages
  */
@@ -139,6 +268,7 @@ struct ExecutionDetails
 };
 
 ExecutionDetails decode_order_execution(const std::vector<unsigned char> & message);
+ExecutionDetails decode_order_execution(unsigned const char * message);
 
 /*
  * Order Restatement
@@ -162,6 +292,19 @@ struct RestatementDetails
 };
 
 RestatementDetails decode_order_restatement(const std::vector<unsigned char> & message);
+RestatementDetails decode_order_restatement(unsigned const char * message);
+
+/*
+ * Returns false for message types other than Order Execution and Order Restatement
+ */
+bool decode_response_type(unsigned const char * message, ResponseType & type);
+
+/*
+ * Inbound message encoders, used by the exchange simulator
+ */
+std::array<unsigned char, exec_order::layout.size> create_order_execution(unsigned seq_no, const ExecutionDetails & details);
+
+std::array<unsigned char, rest_order::layout.size> create_order_restatement(unsigned seq_no, const RestatementDetails & details);
 
 inline void decode(unsigned const char * start, int32_t & value)
 {
@@ -1,10 +1,26 @@
-#if !defined(FIELD) || !defined(VAR_FIELD) || !defined(OPT_FIELD) || !defined(OPT_VAR_FIELD)
-#  error You need to define FIELD, VAR_FIELD and OPT_FIELD macro
+#if !defined(FIELD) || !defined(VAR_FIELD) || !defined(OPT_FIELD) || !defined(OPT_VAR_FIELD) || !defined(RAW_FIELD)
+#  error You need to define FIELD, VAR_FIELD, OPT_FIELD, OPT_VAR_FIELD and RAW_FIELD macro
 #else
 
-VAR_FIELD(cl_ord_id, text, 18, 20)
-FIELD(reason, reason, 46)
+RAW_FIELD(start_of_message, 2)
+RAW_FIELD(message_length, 2)
+RAW_FIELD(message_type, 1)
+RAW_FIELD(matching_unit, 1)
+RAW_FIELD(sequence_number, 4)
+RAW_FIELD(transaction_time, 8)
+VAR_FIELD(cl_ord_id, text, 20)
+RAW_FIELD(order_id, 8)
+FIELD(reason, reason)
+RAW_FIELD(reserved, 1)
+RAW_FIELD(bitfield_count, 1)
+RAW_FIELD(bitfields, rest_order_bitfield_num())
 OPT_FIELD(active_volume, binary4)
 OPT_FIELD(secondary_order_id, text36)
 
+#undef FIELD
+#undef VAR_FIELD
+#undef OPT_FIELD
+#undef OPT_VAR_FIELD
+#undef RAW_FIELD
+
 #endif
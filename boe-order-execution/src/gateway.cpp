@@ -0,0 +1,522 @@
+#include "gateway.h"
+
+#include "requests.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+constexpr size_t max_message_size = std::max({new_order::layout.size, exec_order::layout.size, rest_order::layout.size});
+// start of message marker and message length
+constexpr size_t header_size = exec_order::offset<exec_order::message_type>;
+// an order is answered with at most a restatement and an execution
+constexpr size_t max_reply_size = rest_order::layout.size + exec_order::layout.size;
+
+// frames shorter than this would be decoded past their end
+constexpr size_t layout_size(const ResponseType type)
+{
+    switch (type) {
+    case ResponseType::OrderExecution:
+        return exec_order::layout.size;
+    case ResponseType::OrderRestatement:
+        return rest_order::layout.size;
+    }
+    return 0;
+}
+
+[[noreturn]] void throw_errno(const char * what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+[[noreturn]] void throw_protocol_error(const std::string & what)
+{
+    throw std::runtime_error("protocol error: " + what);
+}
+
+/*
+ * Byte ring buffer, free and readable space is exposed as up to two iovecs
+ * so a single readv/writev moves everything available
+ */
+class RingBuffer
+{
+public:
+    static constexpr size_t capacity = 1 << 16;
+
+    size_t readable() const { return m_size; }
+    size_t writable() const { return capacity - m_size; }
+
+    int readable_segments(iovec (&iov)[2]) const
+    {
+        return segments(m_head, m_size, iov);
+    }
+
+    int writable_segments(iovec (&iov)[2])
+    {
+        return segments((m_head + m_size) % capacity, writable(), iov);
+    }
+
+    void produced(const size_t n) { m_size += n; }
+
+    void consumed(const size_t n)
+    {
+        m_head = (m_head + n) % capacity;
+        m_size -= n;
+    }
+
+    // callers make room first, pushing more than writable() would overwrite unread data
+    void push(unsigned const char * data, const size_t n)
+    {
+        if (n > writable()) {
+            throw std::length_error("RingBuffer::push: buffer full");
+        }
+        const size_t tail = (m_head + m_size) % capacity;
+        const size_t first = std::min(n, capacity - tail);
+        std::memcpy(&m_data[tail], data, first);
+        std::memcpy(&m_data[0], data + first, n - first);
+        m_size += n;
+    }
+
+    // n contiguous readable bytes, copied to scratch if they wrap around
+    unsigned const char * peek(const size_t n, unsigned char * scratch) const
+    {
+        if (m_head + n <= capacity) {
+            return &m_data[m_head];
+        }
+        const size_t first = capacity - m_head;
+        std::memcpy(scratch, &m_data[m_head], first);
+        std::memcpy(scratch + first, &m_data[0], n - first);
+        return scratch;
+    }
+
+private:
+    int segments(const size_t from, const size_t n, iovec (&iov)[2]) const
+    {
+        if (n == 0) {
+            return 0;
+        }
+        const size_t first = std::min(n, capacity - from);
+        iov[0] = {const_cast<unsigned char *>(&m_data[from]), first};
+        if (first == n) {
+            return 1;
+        }
+        iov[1] = {const_cast<unsigned char *>(&m_data[0]), n - first};
+        return 2;
+    }
+
+    std::array<unsigned char, capacity> m_data;
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
+
+// returns false when the peer closed the connection
+bool read_available(const int fd, RingBuffer & buffer)
+{
+    while (buffer.writable() > 0) {
+        iovec iov[2];
+        const int count = buffer.writable_segments(iov);
+        const ssize_t n = readv(fd, iov, count);
+        if (n > 0) {
+            buffer.produced(n);
+        }
+        else if (n == 0) {
+            return false;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;
+        }
+        else if (errno != EINTR) {
+            throw_errno("readv");
+        }
+    }
+    return true;
+}
+
+void write_available(const int fd, RingBuffer & buffer)
+{
+    while (buffer.readable() > 0) {
+        iovec iov[2];
+        const int count = buffer.readable_segments(iov);
+        const ssize_t n = writev(fd, iov, count);
+        if (n >= 0) {
+            buffer.consumed(n);
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        }
+        else if (errno != EINTR) {
+            throw_errno("writev");
+        }
+    }
+}
+
+// calls handler with every complete message and its size (up to limit of them), returns number of messages.
+// A message holds at least its type, handlers check the size against the layout of that type
+template <class Handler>
+size_t for_each_message(RingBuffer & buffer, Handler && handler, const size_t limit = SIZE_MAX)
+{
+    unsigned char scratch[max_message_size];
+    size_t count = 0;
+    while (count < limit) {
+        const size_t available = buffer.readable();
+        if (available < header_size) {
+            return count;
+        }
+        // the length field is checked before waiting for the rest, no known message exceeds scratch
+        const size_t size = frame_size(buffer.peek(header_size, scratch), SIZE_MAX);
+        if (size <= header_size || size > max_message_size) {
+            throw_protocol_error("bad message length " + std::to_string(size));
+        }
+        if (size > available) {
+            return count;
+        }
+        handler(buffer.peek(size, scratch), size);
+        buffer.consumed(size);
+        ++count;
+    }
+    return count;
+}
+
+void set_non_blocking(const int fd)
+{
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        throw_errno("fcntl");
+    }
+}
+
+void set_no_delay(const int fd)
+{
+    const int on = 1;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) < 0) {
+        throw_errno("setsockopt");
+    }
+}
+
+class FileDescriptor
+{
+public:
+    // what names the call which returned fd, for the error thrown if it failed
+    FileDescriptor(const int fd, const char * what)
+        : m_fd(fd)
+    {
+        if (m_fd < 0) {
+            throw_errno(what);
+        }
+    }
+
+    FileDescriptor(const FileDescriptor &) = delete;
+    FileDescriptor & operator=(const FileDescriptor &) = delete;
+
+    ~FileDescriptor()
+    {
+        close(m_fd);
+    }
+
+    int get() const { return m_fd; }
+
+private:
+    const int m_fd;
+};
+
+void watch(const int epoll_fd, const int op, const int fd, const uint32_t events)
+{
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd, op, fd, &event) < 0) {
+        throw_errno("epoll_ctl");
+    }
+}
+
+/*
+ * Exchange side of the connection
+ */
+class Server
+{
+public:
+    Server(const int fd, const size_t restatement_period)
+        : m_fd(fd)
+        , m_restatement_period(restatement_period)
+    {
+        m_execution.exec_id = "D19800001";
+        m_execution.price = 12.34;
+        m_execution.liquidity_indicator = LiquidityIndicator::Added;
+        m_execution.symbol = "ABCDEFG2";
+        m_execution.last_mkt = "XSTO";
+        m_execution.fee_code = "RG";
+        m_restatement.reason = RestatementReason::Reload;
+        m_restatement.secondary_order_id = "ABC123";
+    }
+
+    // returns false when the client closed the connection
+    bool on_readable()
+    {
+        const bool open = read_available(m_fd, m_input);
+        serve();
+        return open;
+    }
+
+    void on_writable()
+    {
+        write_available(m_fd, m_output);
+        serve();
+    }
+
+    bool has_pending_output() const { return m_output.readable() > 0; }
+
+    // with the input buffer full reading waits until output drains and orders get processed
+    bool wants_input() const { return m_input.writable() > 0; }
+
+private:
+    // orders stay in the input buffer while the output buffer can't take their replies,
+    // keep going as long as the socket takes the replies so no processable input is left behind
+    void serve()
+    {
+        while (for_each_message(m_input,
+                                [this](unsigned const char * message, const size_t size) { on_request(message, size); },
+                                m_output.writable() / max_reply_size) > 0) {
+            write_available(m_fd, m_output);
+        }
+    }
+
+    void on_request(unsigned const char * message, const size_t size)
+    {
+        RequestType type;
+        if (!decode_request_type(message, type)) {
+            throw_protocol_error("unexpected request type " + std::to_string(message[new_order::offset<new_order::message_type>]));
+        }
+        switch (type) {
+        case RequestType::New:
+            if (size < new_order::layout.size) {
+                throw_protocol_error("short New Order of " + std::to_string(size) + " bytes");
+            }
+            on_new_order(message);
+            break;
+        }
+    }
+
+    void on_new_order(unsigned const char * message)
+    {
+        decode(message + new_order::offset<new_order::cl_ord_id>, cl_ord_id_field_size, m_execution.cl_ord_id);
+        int32_t volume = 0;
+        decode(message + new_order::offset<new_order::order_qty>, volume);
+
+        if (m_restatement_period != 0 && m_orders % m_restatement_period == 0) {
+            m_restatement.cl_ord_id = m_execution.cl_ord_id;
+            m_restatement.active_volume = volume;
+            const auto restatement = create_order_restatement(++m_seq_no, m_restatement);
+            m_output.push(restatement.data(), restatement.size());
+        }
+        m_execution.filled_volume = volume;
+        m_execution.active_volume = 0;
+        const auto execution = create_order_execution(++m_seq_no, m_execution);
+        m_output.push(execution.data(), execution.size());
+        ++m_orders;
+    }
+
+    const int m_fd;
+    const size_t m_restatement_period;
+    RingBuffer m_input;
+    RingBuffer m_output;
+    ExecutionDetails m_execution{};
+    RestatementDetails m_restatement{};
+    size_t m_orders = 0;
+    unsigned m_seq_no = 0;
+};
+
+/*
+ * Trading side of the connection
+ */
+class Client
+{
+public:
+    Client(const int fd, const GatewayConfig & config, GatewayStats & stats)
+        : m_fd(fd)
+        , m_config(config)
+        , m_stats(stats)
+        , m_send_ticks(config.window)
+    {
+    }
+
+    bool done() const { return m_stats.executions == m_config.order_count; }
+
+    void send_orders()
+    {
+        const std::string cl_ord_id = "ORD1001";
+        const std::string symbol = "AAPl";
+        const std::string account = "ACC331";
+        while (m_stats.orders < m_config.order_count &&
+               m_stats.orders - m_stats.executions < m_config.window &&
+               m_output.writable() >= new_order::layout.size) {
+            const auto order = create_new_order_request(static_cast<unsigned>(m_stats.orders + 1),
+                                                        cl_ord_id,
+                                                        Side::Buy,
+                                                        100,
+                                                        12.505,
+                                                        OrdType::Limit,
+                                                        TimeInForce::Day,
+                                                        10,
+                                                        symbol,
+                                                        Capacity::Principal,
+                                                        account);
+            m_send_ticks[m_stats.orders % m_config.window] = latency::ticks();
+            m_output.push(order.data(), order.size());
+            ++m_stats.orders;
+        }
+        write_available(m_fd, m_output);
+    }
+
+    // returns false when the server closed the connection
+    bool on_readable()
+    {
+        const bool open = read_available(m_fd, m_input);
+        for_each_message(m_input, [this](unsigned const char * message, const size_t size) { on_response(message, size); });
+        send_orders();
+        return open;
+    }
+
+    void on_writable()
+    {
+        write_available(m_fd, m_output);
+    }
+
+    bool has_pending_output() const { return m_output.readable() > 0; }
+
+private:
+    void on_response(unsigned const char * message, const size_t size)
+    {
+        ResponseType type;
+        if (!decode_response_type(message, type)) {
+            return;
+        }
+        if (size < layout_size(type)) {
+            throw_protocol_error("response of " + std::to_string(size) + " bytes is shorter than its layout");
+        }
+        switch (type) {
+        case ResponseType::OrderExecution: {
+            const ExecutionDetails details = decode_order_execution(message);
+            // the server answers in order, so the oldest order in flight is filled
+            m_stats.round_trip.record(latency::ticks() - m_send_ticks[m_stats.executions % m_config.window]);
+            m_stats.filled_volume += details.filled_volume;
+            ++m_stats.executions;
+            break;
+        }
+        case ResponseType::OrderRestatement: {
+            const RestatementDetails details = decode_order_restatement(message);
+            m_stats.restated_volume += details.active_volume;
+            ++m_stats.restatements;
+            break;
+        }
+        }
+    }
+
+    const int m_fd;
+    const GatewayConfig & m_config;
+    GatewayStats & m_stats;
+    RingBuffer m_input;
+    RingBuffer m_output;
+    std::vector<uint64_t> m_send_ticks;
+};
+
+} // anonymous namespace
+
+void run_gateway_simulation(const GatewayConfig & config, GatewayStats & stats)
+{
+    latency::ticks_per_ns();
+
+    FileDescriptor listener(socket(AF_INET, SOCK_STREAM, 0), "socket");
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t address_size = sizeof(address);
+    if (bind(listener.get(), reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        listen(listener.get(), 1) < 0 ||
+        getsockname(listener.get(), reinterpret_cast<sockaddr *>(&address), &address_size) < 0) {
+        throw_errno("listen");
+    }
+
+    // loopback handshake completes in the kernel, so connecting before accept doesn't block
+    FileDescriptor client_fd(socket(AF_INET, SOCK_STREAM, 0), "socket");
+    if (connect(client_fd.get(), reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        throw_errno("connect");
+    }
+    FileDescriptor server_fd(accept(listener.get(), nullptr, nullptr), "accept");
+    for (const int fd : {client_fd.get(), server_fd.get()}) {
+        set_non_blocking(fd);
+        set_no_delay(fd);
+    }
+
+    FileDescriptor epoll_fd(epoll_create1(0), "epoll_create1");
+    watch(epoll_fd.get(), EPOLL_CTL_ADD, client_fd.get(), EPOLLIN);
+    watch(epoll_fd.get(), EPOLL_CTL_ADD, server_fd.get(), EPOLLIN);
+
+    // the ring buffers are too large for the stack
+    auto server = std::make_unique<Server>(server_fd.get(), config.restatement_period);
+    auto client = std::make_unique<Client>(client_fd.get(), config, stats);
+    uint32_t server_events = EPOLLIN;
+    uint32_t client_events = EPOLLIN;
+    const auto update_interest = [&epoll_fd](const int fd, const bool reading, const bool writing, uint32_t & current) {
+        const uint32_t events = (reading ? uint32_t{EPOLLIN} : 0) | (writing ? uint32_t{EPOLLOUT} : 0);
+        if (events != current) {
+            watch(epoll_fd.get(), EPOLL_CTL_MOD, fd, events);
+            current = events;
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    client->send_orders();
+    bool open = true;
+    epoll_event events[4];
+    while (open && !client->done()) {
+        update_interest(client_fd.get(), true, client->has_pending_output(), client_events);
+        update_interest(server_fd.get(), server->wants_input(), server->has_pending_output(), server_events);
+        const int count = epoll_wait(epoll_fd.get(), events, 4, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("epoll_wait");
+        }
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            const uint32_t ready = events[i].events;
+            if (fd == server_fd.get()) {
+                if (ready & EPOLLOUT) {
+                    server->on_writable();
+                }
+                if (ready & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    open = server->on_readable() && open;
+                }
+            }
+            else {
+                if (ready & EPOLLOUT) {
+                    client->on_writable();
+                }
+                if (ready & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    open = client->on_readable() && open;
+                }
+            }
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -1,5 +1,9 @@
+#include "gateway.h"
+#include "latency.h"
 #include "requests.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 
@@ -27,10 +31,108 @@ void print_binary(const T & x)
     }
 }
 
+std::vector<unsigned char> sample_order_execution()
+{
+    return {
+            0xBA, 0xBA, 0x5A, 0x00, 0x2C, 0x03, 0x64, 0x00, 0x00, 0x00, 0xE0, 0xFA, 0x20, 0xF7, 0x36, 0x71, 0xF8, 0x11, 0x41, 0x42, 0x43, 0x31, 0x32, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xF0, 0xB7, 0xD9, 0x71, 0x21, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0x08, 0xE2, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x00, 0x42, 0x41, 0x54, 0x53, 0x00, 0x08, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x32, 0x58, 0x53, 0x54, 0x4F, 0x52, 0x47};
+}
+
+/*
+ * Stress mode
+ *  Encodes New Order, frames and decodes Order Execution message count times,
+ *  prints latency percentiles of every stage
+ */
+void run_stress(const size_t count)
+{
+    latency::ticks_per_ns();
+
+    static latency::Histogram encode_histogram;
+    static latency::Histogram frame_histogram;
+    static latency::Histogram decode_histogram;
+
+    const std::string cl_ord_id = "ORD1001";
+    const std::string symbol = "AAPl";
+    const std::string account = "ACC331";
+    std::vector<unsigned char> message = sample_order_execution();
+    const size_t message_size = message.size();
+
+    size_t checksum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        // vary the input so the work can't be hoisted out of the loop
+        const double price = 12.505 + static_cast<double>(i % 100) / 100;
+        message[exec_order::offset<exec_order::cl_ord_id>] = static_cast<unsigned char>('A' + i % 26);
+
+        uint64_t start = latency::ticks();
+        const auto new_order_msg = create_new_order_request(static_cast<unsigned>(i),
+                                                            cl_ord_id,
+                                                            i % 2 == 0 ? Side::Buy : Side::Sell,
+                                                            100,
+                                                            price,
+                                                            OrdType::Limit,
+                                                            TimeInForce::Day,
+                                                            10,
+                                                            symbol,
+                                                            Capacity::Principal,
+                                                            account);
+        uint64_t end = latency::ticks();
+        encode_histogram.record(end - start);
+        checksum += new_order_msg[new_order::offset<new_order::price>];
+
+        start = latency::ticks();
+        const size_t size = frame_size(&message[0], message_size);
+        end = latency::ticks();
+        frame_histogram.record(end - start);
+        checksum += size;
+
+        start = latency::ticks();
+        const ExecutionDetails details = decode_order_execution(message);
+        end = latency::ticks();
+        decode_histogram.record(end - start);
+        checksum += details.cl_ord_id.size();
+    }
+
+    std::cout << "messages: " << count << ", checksum: " << checksum << std::endl;
+    latency::print_percentiles(std::cout, "encode new order", encode_histogram);
+    latency::print_percentiles(std::cout, "parse frame", frame_histogram);
+    latency::print_percentiles(std::cout, "decode order execution", decode_histogram);
+}
+
+void run_gateway(const GatewayConfig & config)
+{
+    static GatewayStats stats;
+    run_gateway_simulation(config, stats);
+
+    std::cout << "orders: " << stats.orders
+              << ", executions: " << stats.executions
+              << ", restatements: " << stats.restatements
+              << ", filled volume: " << stats.filled_volume << std::endl;
+    std::cout << "elapsed: " << stats.seconds << " s, "
+              << static_cast<double>(stats.executions + stats.restatements) / stats.seconds << " responses/s, "
+              << static_cast<double>(stats.orders) / stats.seconds << " orders/s" << std::endl;
+    latency::print_percentiles(std::cout, "round trip", stats.round_trip);
+}
+
 } // anonymous namespace
 
-int main()
+int main(int argc, char * argv[])
 {
+    if (argc > 1 && std::strcmp(argv[1], "--stress") == 0) {
+        const size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        run_stress(count);
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--gateway") == 0) {
+        GatewayConfig config;
+        if (argc > 2) {
+            config.order_count = std::strtoull(argv[2], nullptr, 10);
+        }
+        if (argc > 3) {
+            config.window = std::max<size_t>(1, std::strtoull(argv[3], nullptr, 10));
+        }
+        run_gateway(config);
+        return 0;
+    }
+
     const auto new_order_msg = create_new_order_request(1,
                                                         "ORD1001",
                                                         Side::Buy,
@@ -44,8 +146,7 @@ int main()
                                                         "ACC331");
     print_binary(new_order_msg);
 
-    const std::vector<unsigned char> message = {
-            0xBA, 0xBA, 0x5A, 0x00, 0x2C, 0x03, 0x64, 0x00, 0x00, 0x00, 0xE0, 0xFA, 0x20, 0xF7, 0x36, 0x71, 0xF8, 0x11, 0x41, 0x42, 0x43, 0x31, 0x32, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xF0, 0xB7, 0xD9, 0x71, 0x21, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0x08, 0xE2, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x00, 0x42, 0x41, 0x54, 0x53, 0x00, 0x08, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x32, 0x58, 0x53, 0x54, 0x4F, 0x52, 0x47};
+    const std::vector<unsigned char> message = sample_order_execution();
 
     ExecutionDetails decodedData = decode_order_execution(message);
     std::cout << "cl_ord_id: " << decodedData.cl_ord_id << std::endl;
@@ -1,10 +1,11 @@
 #include "requests.h"
 
+#include <chrono>
 #include <vector>
 
 namespace {
 
-void encode_new_order_opt_fields(unsigned char * bitfield_start,
+void encode_new_order_opt_fields(unsigned char * start,
                                  const double price,
                                  const char ord_type,
                                  const char time_in_force,
@@ -13,10 +14,9 @@ void encode_new_order_opt_fields(unsigned char * bitfield_start,
                                  const char capacity,
                                  const std::string & account)
 {
-    auto * p = bitfield_start + new_order_bitfield_num();
-#define FIELD(name, bitfield_num, bit)                    \
-    set_opt_field_bit(bitfield_start, bitfield_num, bit); \
-    p = encode_field_##name(p, name);
+    constexpr auto bitfields = new_order_bitfields();
+    std::copy(bitfields.begin(), bitfields.end(), start + new_order::offset<new_order::bitfields>);
+#define FIELD(name, _, __) encode_field_##name(start + new_order::offset<new_order::name>, name);
 #include "new_order_opt_fields.inl"
 }
 
@@ -29,14 +29,13 @@ uint8_t encode_request_type(const RequestType type)
     return 0;
 }
 
-unsigned char * add_request_header(unsigned char * start, unsigned length, const RequestType type, unsigned seq_no)
+void add_request_header(unsigned char * start, unsigned length, const RequestType type, unsigned seq_no)
 {
-    *start++ = 0xBA;
-    *start++ = 0xBA;
-    start = encode(start, static_cast<uint16_t>(length));
-    start = encode(start, encode_request_type(type));
-    *start++ = 0;
-    return encode(start, seq_no);
+    encode(start + new_order::offset<new_order::start_of_message>, static_cast<uint16_t>(0xBABA));
+    encode(start + new_order::offset<new_order::message_length>, static_cast<uint16_t>(length));
+    encode(start + new_order::offset<new_order::message_type>, encode_request_type(type));
+    encode(start + new_order::offset<new_order::matching_unit>, static_cast<uint8_t>(0));
+    encode(start + new_order::offset<new_order::sequence_number>, static_cast<uint32_t>(seq_no));
 }
 
 char convert_side(const Side side)
@@ -93,14 +92,17 @@ std::array<unsigned char, calculate_size(RequestType::New)> create_new_order_req
                                                                                      const std::string & account)
 {
     static_assert(calculate_size(RequestType::New) == 78, "Wrong New Order message size");
-
-    std::array<unsigned char, calculate_size(RequestType::New)> msg;
-    auto * p = add_request_header(&msg[0], msg.size() - 2, RequestType::New, seq_no);
-    p = encode_text(p, cl_ord_id, 20);
-    p = encode_char(p, convert_side(side));
-    p = encode_binary4(p, static_cast<uint32_t>(volume));
-    p = encode(p, static_cast<uint8_t>(new_order_bitfield_num()));
-    encode_new_order_opt_fields(p,
+    static_assert(new_order::offset<new_order::cl_ord_id> == 10, "Wrong New Order header size");
+    static_assert(new_order::offset<new_order::bitfields> == 36, "Wrong New Order bitfields offset");
+
+    std::array<unsigned char, calculate_size(RequestType::New)> msg{};
+    auto * start = &msg[0];
+    add_request_header(start, msg.size() - 2, RequestType::New, seq_no);
+    encode_field_cl_ord_id(start + new_order::offset<new_order::cl_ord_id>, cl_ord_id);
+    encode_field_side(start + new_order::offset<new_order::side>, convert_side(side));
+    encode_field_order_qty(start + new_order::offset<new_order::order_qty>, static_cast<uint32_t>(volume));
+    encode(start + new_order::offset<new_order::bitfield_count>, static_cast<uint8_t>(new_order_bitfield_num()));
+    encode_new_order_opt_fields(start,
                                 price,
                                 convert_ord_type(ord_type),
                                 convert_time_in_force(time_in_force),
@@ -111,6 +113,8 @@ std::array<unsigned char, calculate_size(RequestType::New)> create_new_order_req
     return msg;
 }
 
+namespace {
+
 void decode_text(unsigned const char * start, const size_t size, std::string & str)
 {
     decode(start, size, str);
@@ -118,7 +122,7 @@ void decode_text(unsigned const char * start, const size_t size, std::string & s
 
 std::string convert_to_base(int64_t value, int radix)
 {
-    const char * base_symbols = "0123456789ABCDEFGHIJKLMNOPQRASUVWXYZ";
+    const char * base_symbols = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
     std::string result = "";
 
     while (value != 0) {
@@ -161,72 +165,199 @@ void decode_reason(unsigned const char * start, RestatementReason & value)
     value = convert_restatement_reason(*start);
 }
 
-#define FIELD(name, type, offset) decode_##type(start + offset, ORDER.name);
-#define VAR_FIELD(name, type, offset, size) decode_##type(start + offset, size, ORDER.name);
-#define OPT_VAR_FIELD(name, type, size)                     \
-    decode_##type(last_opt_field_offset, size, ORDER.name); \
-    last_opt_field_offset += size;
-#define OPT_FIELD(name, type)                         \
-    decode_##type(last_opt_field_offset, ORDER.name); \
-    last_opt_field_offset += type##_size;
+uint8_t encode_response_type(const ResponseType type)
+{
+    switch (type) {
+    case ResponseType::OrderExecution:
+        return 0x2C;
+    case ResponseType::OrderRestatement:
+        return 0x28;
+    }
+    return 0;
+}
+
+void add_response_header(unsigned char * start, unsigned length, const ResponseType type, unsigned seq_no)
+{
+    static_assert(exec_order::offset<exec_order::cl_ord_id> == rest_order::offset<rest_order::cl_ord_id>,
+                  "Inbound messages must share the header layout");
+
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    encode(start + exec_order::offset<exec_order::start_of_message>, static_cast<uint16_t>(0xBABA));
+    encode(start + exec_order::offset<exec_order::message_length>, static_cast<uint16_t>(length));
+    encode(start + exec_order::offset<exec_order::message_type>, encode_response_type(type));
+    encode(start + exec_order::offset<exec_order::matching_unit>, static_cast<uint8_t>(0));
+    encode(start + exec_order::offset<exec_order::sequence_number>, static_cast<uint32_t>(seq_no));
+    encode(start + exec_order::offset<exec_order::transaction_time>,
+           static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()));
+}
 
-ExecutionDetails decode_order_execution(const std::vector<unsigned char> & message)
+int64_t convert_from_base(const std::string & str, int radix)
+{
+    int64_t result = 0;
+    for (const char ch : str) {
+        const int digit = ch <= '9' ? ch - '0' : ch - 'A' + 10;
+        result = result * radix + digit;
+    }
+    return result;
+}
+
+unsigned char * encode_text36(unsigned char * start, const std::string & str)
 {
-#define BITFIELD_OFFSET 70
+    return encode(start, convert_from_base(str, 36));
+}
+
+unsigned char * encode_liquidity_indicator(unsigned char * start, const LiquidityIndicator value)
+{
+    switch (value) {
+    case LiquidityIndicator::Added: return encode_char(start, 'A');
+    case LiquidityIndicator::Removed: return encode_char(start, 'R');
+    case LiquidityIndicator::Unknown: break;
+    }
+    return encode_char(start, ' ');
+}
+
+unsigned char * encode_reason(unsigned char * start, const RestatementReason value)
+{
+    switch (value) {
+    case RestatementReason::Reroute: return encode_char(start, 'R');
+    case RestatementReason::LockedInCross: return encode_char(start, 'X');
+    case RestatementReason::Wash: return encode_char(start, 'W');
+    case RestatementReason::Reload: return encode_char(start, 'L');
+    case RestatementReason::LiquidityUpdated: return encode_char(start, 'Q');
+    case RestatementReason::Unknown: break;
+    }
+    return encode_char(start, ' ');
+}
+
+} // anonymous namespace
+
+ExecutionDetails decode_order_execution(unsigned const char * message)
+{
+    static_assert(exec_order::offset<exec_order::cl_ord_id> == 18, "Wrong Order Execution header size");
+    static_assert(exec_order::offset<exec_order::liquidity_indicator> == 62, "Wrong Order Execution layout");
+    static_assert(exec_order::offset<exec_order::bitfields> == 70, "Wrong Order Execution bitfields offset");
+
+#define LAYOUT exec_order
 #define ORDER exec_details
 
     ExecutionDetails exec_details;
-    unsigned const char * start = &message[0];
-    unsigned const char * last_opt_field_offset = start + BITFIELD_OFFSET + exec_order_bitfield_num();
+    unsigned const char * start = message;
 
+#include "decode_fields.inl"
 #include "exec_order_fields.inl"
 
     return exec_details;
 
-#undef BITFIELD_OFFSET
+#undef LAYOUT
 #undef ORDER
 }
 
-RestatementDetails decode_order_restatement(const std::vector<unsigned char> & message)
+RestatementDetails decode_order_restatement(unsigned const char * message)
 {
-#define BITFIELD_OFFSET 49
+    static_assert(rest_order::offset<rest_order::reason> == 46, "Wrong Order Restatement layout");
+    static_assert(rest_order::offset<rest_order::bitfields> == 49, "Wrong Order Restatement bitfields offset");
+
+#define LAYOUT rest_order
 #define ORDER restatement_details
 
     RestatementDetails restatement_details;
-    unsigned const char * start = &message[0];
-    unsigned const char * last_opt_field_offset = start + BITFIELD_OFFSET + rest_order_bitfield_num();
+    unsigned const char * start = message;
 
+#include "decode_fields.inl"
 #include "rest_order_fields.inl"
 
-#undef FIELD
-#undef VAR_FIELD
-#undef OPT_FIELD
-#undef OPT_VAR_FIELD
-
     return restatement_details;
 
-#undef BITFIELD_OFFSET
+#undef LAYOUT
 #undef ORDER
 }
 
-std::vector<unsigned char> request_optional_fields_for_message(const ResponseType type)
+ExecutionDetails decode_order_execution(const std::vector<unsigned char> & message)
+{
+    return decode_order_execution(message.data());
+}
+
+RestatementDetails decode_order_restatement(const std::vector<unsigned char> & message)
+{
+    return decode_order_restatement(message.data());
+}
+
+bool decode_request_type(unsigned const char * message, RequestType & type)
+{
+    switch (message[new_order::offset<new_order::message_type>]) {
+    case 0x38:
+        type = RequestType::New;
+        return true;
+    }
+    return false;
+}
+
+bool decode_response_type(unsigned const char * message, ResponseType & type)
 {
-    std::vector<unsigned char> result;
+    switch (message[exec_order::offset<exec_order::message_type>]) {
+    case 0x2C:
+        type = ResponseType::OrderExecution;
+        return true;
+    case 0x28:
+        type = ResponseType::OrderRestatement;
+        return true;
+    }
+    return false;
+}
+
+std::array<unsigned char, exec_order::layout.size> create_order_execution(const unsigned seq_no, const ExecutionDetails & details)
+{
+#define LAYOUT exec_order
+#define ORDER details
+
+    std::array<unsigned char, exec_order::layout.size> msg{};
+    auto * start = &msg[0];
+    add_response_header(start, msg.size() - 2, ResponseType::OrderExecution, seq_no);
+    encode(start + exec_order::offset<exec_order::bitfield_count>, static_cast<uint8_t>(exec_order_bitfield_num()));
+    constexpr auto bitfields = exec_order_bitfields();
+    std::copy(bitfields.begin(), bitfields.end(), start + exec_order::offset<exec_order::bitfields>);
 
+#include "encode_fields.inl"
+#include "exec_order_fields.inl"
+
+    return msg;
+
+#undef LAYOUT
+#undef ORDER
+}
+
+std::array<unsigned char, rest_order::layout.size> create_order_restatement(const unsigned seq_no, const RestatementDetails & details)
+{
+#define LAYOUT rest_order
+#define ORDER details
+
+    std::array<unsigned char, rest_order::layout.size> msg{};
+    auto * start = &msg[0];
+    add_response_header(start, msg.size() - 2, ResponseType::OrderRestatement, seq_no);
+    encode(start + rest_order::offset<rest_order::bitfield_count>, static_cast<uint8_t>(rest_order_bitfield_num()));
+    constexpr auto bitfields = rest_order_bitfields();
+    std::copy(bitfields.begin(), bitfields.end(), start + rest_order::offset<rest_order::bitfields>);
+
+#include "encode_fields.inl"
+#include "rest_order_fields.inl"
+
+    return msg;
+
+#undef LAYOUT
+#undef ORDER
+}
+
+std::vector<unsigned char> request_optional_fields_for_message(const ResponseType type)
+{
     switch (type) {
-    case ResponseType::OrderExecution:
-        result.resize(exec_order_bitfield_num());
-#define FIELD(name, bitfield_num, bit) \
-    set_opt_field_bit(&result[0], bitfield_num, bit);
-#include "exec_order_opt_fields.inl"
-        break;
-    case ResponseType::OrderRestatement:
-        result.resize(rest_order_bitfield_num());
-#define FIELD(name, bitfield_num, bit) \
-    set_opt_field_bit(&result[0], bitfield_num, bit);
-#include "rest_order_opt_fields.inl"
-        break;
+    case ResponseType::OrderExecution: {
+        constexpr auto bitfields = exec_order_bitfields();
+        return {bitfields.begin(), bitfields.end()};
     }
-#undef FIELD
-    return result;
+    case ResponseType::OrderRestatement: {
+        constexpr auto bitfields = rest_order_bitfields();
+        return {bitfields.begin(), bitfields.end()};
+    }
+    }
+    return {};
 }
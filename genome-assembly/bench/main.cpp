@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "ga/Genome.hpp"
+#include "ga/Graph.hpp"
+#include "ga/MappedReader.hpp"
+#include "ga/SequenceReader.hpp"
+#include "ga/Simulator.hpp"
+
+namespace {
+
+template <class F>
+double measure(F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchGraph(size_t maxLength, size_t maxThreads) {
+    const size_t k          = 31;
+    const size_t readLength = 100;
+    const double coverage   = 10;
+    for (size_t length = 1000000; length <= maxLength; length *= 10) {
+        const std::vector<std::string> reads =
+            genome::sample_reads(genome::random_genome(length, 1), {readLength, coverage, 0, false, 2});
+        std::cout << "genome " << length << " bases, " << reads.size() << " reads of " << readLength << std::endl;
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            genome::DeBruijnGraph<1> graph(k, threads > 1 ? 8 : 0);
+            const double ms = measure([&] { graph.add_reads(reads, threads); });
+            std::cout << "  " << threads << " threads: " << ms << " ms, "
+                      << static_cast<double>(reads.size() * readLength) / ms / 1000 << " Mbases/s (" << graph.node_count()
+                      << " nodes, " << graph.memory() / 1000000 << " MB)" << std::endl;
+        }
+    }
+}
+
+// largest resident set of the process so far, it only grows, so run a single section to measure one
+size_t peakMemory() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Linux reports it in KiB
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+}
+
+void printStages(const genome::AssemblyStats& stats) {
+    std::cout << "    count " << stats.count_ms << " ms, build " << stats.build_ms << " ms, adjacency "
+              << stats.adjacency_ms << " ms";
+    if (stats.compact_ms > 0) {
+        std::cout << ", compact " << stats.compact_ms << " ms";
+    } else {
+        std::cout << ", start " << stats.start_ms << " ms, walk " << stats.walk_ms << " ms, merge " << stats.merge_ms
+                  << " ms";
+    }
+    std::cout << std::endl
+              << "    " << stats.nodes << " nodes, " << stats.edges << " edges, graph " << stats.graph_memory / 1000000
+              << " MB, peak " << peakMemory() / 1000000 << " MB" << std::endl;
+}
+
+// contigs found on either strand of the reference. Their first k-mer, k at most 32, is looked up
+// among the reference's sorted k-mers and the rest compared from there
+size_t matchingContigs(const std::string& reference, const std::vector<std::string>& contigs, size_t k) {
+    std::vector<std::pair<uint64_t, uint32_t>> kmers;
+    kmers.reserve(reference.size());
+    genome::Kmer<1> kmer;
+    for (size_t i = 0; i < reference.size(); i++) {
+        kmer.push(static_cast<uint64_t>(genome::encode_base(reference[i])), k);
+        if (i + 1 >= k) {
+            kmers.emplace_back(kmer.words[0], static_cast<uint32_t>(i + 1 - k));
+        }
+    }
+    std::sort(kmers.begin(), kmers.end());
+
+    const auto found = [&](const std::string& contig) {
+        genome::Kmer<1> first;
+        for (size_t i = 0; i < k; i++) {
+            first.push(static_cast<uint64_t>(genome::encode_base(contig[i])), k);
+        }
+        for (auto it = std::lower_bound(kmers.begin(), kmers.end(), std::make_pair(first.words[0], uint32_t{0}));
+             it != kmers.end() && it->first == first.words[0]; ++it) {
+            if (reference.compare(it->second, contig.size(), contig) == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+    return static_cast<size_t>(std::count_if(contigs.begin(), contigs.end(), [&](const std::string& contig) {
+        return found(contig) || found(genome::reverse_complement(contig));
+    }));
+}
+
+// length of the shortest of the longest contigs that together hold half of the bases
+size_t n50(std::vector<std::string> contigs) {
+    std::sort(contigs.begin(), contigs.end(),
+              [](const std::string& a, const std::string& b) { return a.size() > b.size(); });
+    size_t total = 0;
+    for (const std::string& contig : contigs) {
+        total += contig.size();
+    }
+    size_t sum = 0;
+    for (const std::string& contig : contigs) {
+        sum += contig.size();
+        if (2 * sum >= total) {
+            return contig.size();
+        }
+    }
+    return 0;
+}
+
+// the whole pipeline stage by stage on simulated data, checked against the genome it came from:
+// assembly of error-free tiled reads from a random and a repeat-rich genome, where repeats longer than k
+// allow other Euler paths than the genome, and contigs of reads with 1% errors from both strands at 30x coverage,
+// where dropping (k+1)-mers seen less than 4 times leaves almost no error
+void benchAssembly(size_t maxLength, size_t threads) {
+    const size_t k          = 31;
+    const size_t readLength = 100;
+    for (size_t length = 1000000; length <= maxLength; length *= 10) {
+        for (const bool repeats : {false, true}) {
+            const std::string reference = repeats ? genome::repeat_genome(length, 2000, 16, 3)
+                                                  : genome::random_genome(length, 11);
+            const std::vector<std::string> reads = genome::tile_reads(reference, readLength, k);
+            std::cout << (repeats ? "repeat-rich" : "random") << " genome " << length << " bases, " << reads.size()
+                      << " tiled reads of " << readLength << std::endl;
+            genome::AssemblyStats stats;
+            std::string result;
+            const double total = measure([&] { result = genome::assembly(k, reads, {threads, 1, 0, false, &stats}); });
+            std::cout << "  assembly: " << total << " ms, " << result.size() << " bases, "
+                      << (result == reference ? "matches the reference" : "differs from the reference") << std::endl;
+            printStages(stats);
+        }
+
+        const std::string reference          = genome::random_genome(length, 12);
+        const std::vector<std::string> reads = genome::sample_reads(reference, {readLength, 30, 0.01, true, 13});
+        std::cout << "random genome " << length << " bases, " << reads.size() << " reads of " << readLength
+                  << " with 1% errors from both strands" << std::endl;
+        genome::AssemblyStats stats;
+        std::vector<std::string> contigs;
+        const double total =
+            measure([&] { contigs = genome::contigs(k, reads, {threads, 4, 0, true, &stats}); });
+        std::cout << "  contigs: " << total << " ms, " << contigs.size() << " contigs, N50 " << n50(contigs) << ", "
+                  << matchingContigs(reference, contigs, k) << " found in the reference" << std::endl;
+        printStages(stats);
+    }
+}
+
+// reads with 1% errors at 30x coverage, graph built with and without dropping (k+1)-mers seen less than 3 times
+void benchAbundance(size_t maxLength) {
+    const size_t k          = 31;
+    const size_t readLength = 100;
+    const uint32_t minCount = 3;
+    for (size_t length = 1000000; length <= maxLength; length *= 10) {
+        const std::vector<std::string> reads =
+            genome::sample_reads(genome::random_genome(length, 6), {readLength, 30, 0.01, false, 7});
+        std::cout << "genome " << length << " bases, " << reads.size() << " reads of " << readLength
+                  << " with 1% errors" << std::endl;
+
+        size_t full = 0;
+        {
+            genome::DeBruijnGraph<1> graph(k);
+            const double build = measure([&] { graph.add_reads(reads, 1); });
+            full               = graph.memory();
+            const double prune = measure([&] { graph.prune(minCount); });
+            std::cout << "  unfiltered: build " << build << " ms, prune " << prune << " ms, " << full / 1000000
+                      << " MB, " << graph.node_count() << " nodes" << std::endl;
+        }
+
+        genome::DeBruijnGraph<1> graph(k);
+        graph.filter(reads.size() * readLength, minCount);
+        const double count  = measure([&] { graph.count_reads(reads, 1); });
+        const size_t sketch = graph.filter_memory();
+        const double build  = measure([&] { graph.add_reads(reads, 1); });
+        const size_t peak   = graph.memory() + sketch;
+        const double prune  = measure([&] { graph.prune(minCount); });
+        std::cout << "  filtered: count " << count << " ms, build " << build << " ms, prune " << prune << " ms, "
+                  << graph.memory() / 1000000 << " MB + " << sketch / 1000000 << " MB sketch, "
+                  << graph.node_count() << " nodes, " << (full - std::min(full, peak)) / 1000000 << " MB saved"
+                  << std::endl;
+    }
+}
+
+// reads from both strands, graph of the k-mers as read and of canonical k-mers
+void benchCanonical(size_t maxLength) {
+    const size_t k          = 31;
+    const size_t readLength = 100;
+    for (size_t length = 1000000; length <= maxLength; length *= 10) {
+        const std::vector<std::string> reads =
+            genome::sample_reads(genome::random_genome(length, 9), {readLength, 10, 0, true, 10});
+        std::cout << "genome " << length << " bases, " << reads.size() << " reads of " << readLength
+                  << " from both strands" << std::endl;
+        {
+            genome::DeBruijnGraph<1> graph(k);
+            const double ms = measure([&] { graph.add_reads(reads, 1); });
+            std::cout << "  as read: " << ms << " ms, " << graph.node_count() << " nodes, " << graph.memory() / 1000000
+                      << " MB" << std::endl;
+        }
+        genome::DeBruijnGraph<1, true> graph(k);
+        const double ms = measure([&] { graph.add_reads(reads, 1); });
+        std::cout << "  canonical: " << ms << " ms, " << graph.node_count() << " nodes, " << graph.memory() / 1000000
+                  << " MB" << std::endl;
+    }
+}
+
+// parses FASTA with 60 bases per line and FASTQ from a temporary file of about the given size
+void benchReader(size_t size) {
+    const std::vector<std::string> reads = genome::sample_reads(
+        genome::random_genome(1000000, 4), {150, static_cast<double>(size / 1000000), 0, false, 5});
+    const std::string path               = (std::filesystem::temp_directory_path() / "ga_bench_reads").string();
+    for (const bool fastq : {false, true}) {
+        {
+            std::ofstream output(path, std::ios::binary);
+            for (size_t i = 0; i < reads.size(); i++) {
+                if (fastq) {
+                    output << '@' << i << '\n' << reads[i] << "\n+\n" << std::string(reads[i].size(), 'I') << '\n';
+                } else {
+                    output << '>' << i << '\n';
+                    for (size_t line = 0; line < reads[i].size(); line += 60) {
+                        output << reads[i].substr(line, 60) << '\n';
+                    }
+                }
+            }
+        }
+        const double bytes = static_cast<double>(std::filesystem::file_size(path));
+        std::cout << (fastq ? "FASTQ " : "FASTA ") << bytes / 1e6 << " MB, " << reads.size() << " reads" << std::endl;
+
+        size_t bases        = 0;
+        const double mapped = measure([&] {
+            genome::MappedReader reader(path);
+            std::string_view read;
+            while (reader.next(read)) {
+                bases += read.size();
+            }
+        });
+        const double streamed = measure([&] {
+            std::ifstream input(path, std::ios::binary);
+            genome::SequenceReader reader(input);
+            std::string read;
+            while (reader.next(read)) {
+                bases += read.size();
+            }
+        });
+        std::cout << "  MappedReader: " << mapped << " ms, " << bytes / mapped / 1e6 << " GB/s" << std::endl;
+        std::cout << "  SequenceReader: " << streamed << " ms, " << bytes / streamed / 1e6 << " GB/s" << std::endl;
+    }
+    std::filesystem::remove(path);
+}
+
+}  // namespace
+
+// usage: bench [all|graph|assembly|abundance|canonical|reader] [max genome length] [max threads]
+// the reader section writes files of about 100 (FASTA) and 200 (FASTQ) bytes per base of the max genome length
+int main(int argc, char* argv[]) {
+    const std::string section = argc > 1 ? argv[1] : "all";
+    const size_t length       = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+    const size_t threads =
+        argc > 3 ? std::strtoull(argv[3], nullptr, 10) : std::max<size_t>(1, std::thread::hardware_concurrency());
+    const auto enabled = [&section](const char* name) { return section == "all" || section == name; };
+    if (enabled("graph")) {
+        benchGraph(length, threads);
+    }
+    if (enabled("assembly")) {
+        benchAssembly(length, threads);
+    }
+    if (enabled("abundance")) {
+        benchAbundance(length);
+    }
+    if (enabled("canonical")) {
+        benchCanonical(length);
+    }
+    if (enabled("reader")) {
+        benchReader(length * 100);
+    }
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef GA_ADJACENCY_HPP
+#define GA_ADJACENCY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace genome {
+
+// out-edges of a de Bruijn graph in compressed sparse row form over integer node ids:
+// the edges of node v are targets[offsets[v]] .. targets[offsets[v + 1] - 1] in A, C, G, T order,
+// each one standing for multiplicity[i] parallel edges
+// For a graph of canonical k-mers node 2v is k-mer v read forward and node 2v + 1 its reverse complement,
+// the edges from one are the reverse complements of the edges into the other. Degrees are left empty then
+struct Adjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> multiplicity;
+    // the base every edge into the node appends, as a character
+    std::vector<char> last_base;
+    // edges into and out of the node, counting parallel ones
+    std::vector<uint32_t> in_degree;
+    std::vector<uint32_t> out_degree;
+
+    [[nodiscard]] size_t node_count() const { return last_base.size(); }
+};
+
+}  // namespace genome
+
+#endif  // GA_ADJACENCY_HPP
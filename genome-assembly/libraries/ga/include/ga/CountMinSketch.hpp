@@ -0,0 +1,59 @@
+#ifndef GA_COUNT_MIN_SKETCH_HPP
+#define GA_COUNT_MIN_SKETCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace genome {
+
+// approximate counts of hashed items in two rows of 8-bit saturating counters, one picked in each row
+// by a different half of the hash. An estimate is never below the true count (up to 255),
+// so a threshold on it only lets rare items through, never drops frequent ones. Threads may add concurrently
+class CountMinSketch {
+public:
+    static constexpr uint32_t max_count = UINT8_MAX;
+
+    // the number of counters is rounded up to a power of 2, at least 2
+    explicit CountMinSketch(size_t counters) {
+        size_t width = 1;
+        while (2 * width < counters) {
+            width *= 2;
+        }
+        m_mask     = width - 1;
+        m_counters = std::make_unique<std::atomic<uint8_t>[]>(2 * width);
+    }
+
+    void add(uint64_t hash) {
+        increment(m_counters[index(hash, 0)]);
+        increment(m_counters[index(hash, 1)]);
+    }
+
+    [[nodiscard]] uint32_t estimate(uint64_t hash) const {
+        return std::min(m_counters[index(hash, 0)].load(std::memory_order_relaxed),
+                        m_counters[index(hash, 1)].load(std::memory_order_relaxed));
+    }
+
+    [[nodiscard]] size_t memory() const { return 2 * (m_mask + 1) * sizeof(std::atomic<uint8_t>); }
+
+private:
+    [[nodiscard]] size_t index(uint64_t hash, size_t row) const {
+        return row * (m_mask + 1) + (static_cast<size_t>(hash >> 32 * row) & m_mask);
+    }
+
+    static void increment(std::atomic<uint8_t>& counter) {
+        uint8_t value = counter.load(std::memory_order_relaxed);
+        while (value < max_count &&
+               !counter.compare_exchange_weak(value, static_cast<uint8_t>(value + 1), std::memory_order_relaxed)) {
+        }
+    }
+
+    size_t m_mask;
+    std::unique_ptr<std::atomic<uint8_t>[]> m_counters;
+};
+
+}  // namespace genome
+
+#endif  // GA_COUNT_MIN_SKETCH_HPP
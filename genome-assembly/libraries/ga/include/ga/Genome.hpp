@@ -1,15 +1,68 @@
 #ifndef GA_GENOME_HPP
 #define GA_GENOME_HPP
 
-#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
 #include <string>
-#include <string_view>
-#include <unordered_map>
 #include <vector>
 
 namespace genome {
 
-std::string assembly(size_t, const std::vector<std::string>&);
+class MappedReader;
+
+// time in milliseconds and size of the stages of one call, the ones it does not run stay 0
+struct AssemblyStats {
+    // first pass over the reads, counting (k+1)-mers in the abundance filter's sketch
+    double count_ms{0};
+    // adding the reads to the graph and pruning the rare (k+1)-mers
+    double build_ms{0};
+    double adjacency_ms{0};
+    // assembly: finding where the Euler path starts, walking it and spelling the genome along it
+    double start_ms{0};
+    double walk_ms{0};
+    double merge_ms{0};
+    // contigs: spelling the unitigs
+    double compact_ms{0};
+    size_t nodes{0};
+    size_t edges{0};
+    // bytes held by the built graph
+    size_t graph_memory{0};
+};
+
+struct AssemblyOptions {
+    // threads building the graph, 0 for one per hardware thread
+    size_t threads{1};
+    // (k+1)-mers read fewer times are taken for sequencing errors and left out of the graph, 1 keeps all.
+    // A count-min sketch counts them in a first pass over the reads, so the rare ones never take space
+    // in the graph; stream input is read once and only drops them after building the graph
+    uint32_t min_abundance{1};
+    // 8-bit counters of the sketch, 0 for one per input base
+    size_t sketch_counters{0};
+    // a k-mer and its reverse complement are one node, for reads from both strands. Only contigs support it,
+    // assembly throws std::invalid_argument, and so do contigs for an even k
+    bool canonical{false};
+    // filled in if set
+    AssemblyStats* stats{nullptr};
+};
+
+// both walk an Euler path through the de Bruijn graph of the reads' k-mers, k is at most max_k (ga/Kmer.hpp),
+// std::invalid_argument is thrown for a larger one. std::runtime_error is thrown if the graph has no Euler path
+// covering all its edges: a node whose in- and out-degree differ by more than one, more than one start or end,
+// or edges in several connected components
+std::string assembly(size_t, const std::vector<std::string>&, const AssemblyOptions& = {});
+// reads streamed from FASTA, FASTQ or plain text with one read per line (see SequenceReader)
+std::string assembly(size_t, std::istream&, const AssemblyOptions& = {});
+// reads parsed in place from a memory-mapped file, the fastest input
+std::string assembly(size_t, MappedReader&, const AssemblyOptions& = {});
+
+// unitigs of the de Bruijn graph: the maximal paths whose inner k-mers have one distinct predecessor and successor.
+// Unlike assembly they need no Euler path, so reads with errors and coverage gaps give the pieces
+// of the genome that are certain, in no particular order. Parallel edges count once,
+// options.threads also spell the unitigs
+std::vector<std::string> contigs(size_t, const std::vector<std::string>&, const AssemblyOptions& = {});
+std::vector<std::string> contigs(size_t, std::istream&, const AssemblyOptions& = {});
+std::vector<std::string> contigs(size_t, MappedReader&, const AssemblyOptions& = {});
 
 }  // namespace genome
 
@@ -0,0 +1,560 @@
+#ifndef GA_GRAPH_HPP
+#define GA_GRAPH_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ga/Adjacency.hpp"
+#include "ga/CountMinSketch.hpp"
+#include "ga/Kmer.hpp"
+#include "ga/KmerTable.hpp"
+
+namespace genome {
+
+// de Bruijn graph of the k-mers of the reads with one edge per (k+1)-mer occurrence.
+// Nodes are numbered by KmerTables. An edge is fixed by its source and the base it appends,
+// so the adjacency of a node is the multiplicity of each of its 4 possible out-edges.
+// In- and out-degrees are counted while the reads are added.
+// The k-mers are spread by hash over 2^partition_bits tables, which add_reads fills in parallel.
+// Node ids run through the partitions one after another, so they shift while reads are added.
+//
+// With Canonical, a k-mer and its reverse complement are one node keyed by the smaller of the two,
+// so reads from both strands of a genome share their nodes. Edges are then bidirected:
+// a node has 8 edge slots, appending A, C, G, T to its k-mer and to its reverse complement, and every
+// (k+1)-mer is counted at both ends in the orientation it meets them. Degrees are not counted.
+// A palindromic (k+1)-mer, its own reverse complement, has both ends at the same node in opposite
+// orientations and is counted twice there. k should be odd, so no k-mer is its own reverse complement
+// (contigs reject an even k)
+template <size_t Words, bool Canonical = false>
+class DeBruijnGraph {
+public:
+    using Node = uint32_t;
+
+    static constexpr Node npos         = KmerTable<Words>::npos;
+    static constexpr bool canonical    = Canonical;
+    static constexpr size_t edge_slots = Canonical ? 8 : 4;
+
+    explicit DeBruijnGraph(size_t k, size_t partition_bits = 0)
+        : m_k(k),
+          m_partition_bits(partition_bits),
+          m_partitions(std::make_unique<Partition[]>(size_t{1} << partition_bits)),
+          m_offsets((size_t{1} << partition_bits) + 1) {}
+
+    // adds the (k+1)-mers of the read, runs of other characters than ACGT split it
+    void add_read(std::string_view read) {
+        scan(read, [this](const Kmer<Words>& kmer, size_t hash, uint8_t out, uint8_t in) {
+            m_edge_count += add(m_partitions[partition_of(hash)], Entry{kmer, hash, out, in});
+        });
+        update_offsets();
+    }
+
+    // adds a range of reads (anything convertible to std::string_view) on the given number of threads.
+    // Each thread buffers its k-mers per partition and inserts a full buffer under the partition's lock,
+    // so with many more partitions than threads they rarely wait for each other
+    template <class Reads>
+    void add_reads(const Reads& reads, size_t threads) {
+        const size_t count = static_cast<size_t>(std::distance(std::begin(reads), std::end(reads)));
+        if (threads <= 1 || count < 2) {
+            for (const auto& read : reads) {
+                add_read(read);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next_chunk{0};
+        add_chunks(range_chunks(reads, count, next_chunk), threads);
+    }
+
+    // adds the reads of a reader with bool next(std::string_view&), like MappedReader, on the given number
+    // of threads. The threads take turns to pull a chunk of reads, so they are never all held at once
+    template <class Reader>
+    void add_stream(Reader& reader, size_t threads) {
+        std::string_view read;
+        if (threads <= 1) {
+            while (reader.next(read)) {
+                add_read(read);
+            }
+            return;
+        }
+
+        std::mutex mutex;
+        add_chunks(stream_chunks(reader, mutex), threads);
+    }
+
+    // makes the following add_read(s) and add_stream calls skip the (k+1)-mers a count-min sketch
+    // of the given number of counters has seen less than min_count times, which saturates at
+    // CountMinSketch::max_count. The reads have to be passed to count_reads or count_stream first,
+    // prune(min_count) then drops the edges the sketch overestimated
+    void filter(size_t counters, uint32_t min_count) {
+        m_sketch    = std::make_unique<CountMinSketch>(counters);
+        m_min_count = std::min(min_count, CountMinSketch::max_count);
+    }
+
+    // counts the (k+1)-mers of the reads in the sketch of filter(), on the given number of threads
+    template <class Reads>
+    void count_reads(const Reads& reads, size_t threads) {
+        const size_t count = static_cast<size_t>(std::distance(std::begin(reads), std::end(reads)));
+        std::atomic<size_t> next_chunk{0};
+        count_chunks(range_chunks(reads, count, next_chunk), threads);
+    }
+
+    template <class Reader>
+    void count_stream(Reader& reader, size_t threads) {
+        std::mutex mutex;
+        count_chunks(stream_chunks(reader, mutex), threads);
+    }
+
+    // removes the edges seen less than min_count times, without a filter() the ones of a single pass,
+    // and frees the sketch. The k-mers of removed edges stay as nodes, possibly without any edge
+    void prune(uint32_t min_count) {
+        if constexpr (Canonical) {
+            // both ends of an edge count it alike, so it leaves both here
+            size_t removed = 0;
+            for (size_t p = 0; p < partition_count(); p++) {
+                for (auto& edges : m_partitions[p].out_edges) {
+                    for (uint32_t& multiplicity : edges) {
+                        if (multiplicity < min_count) {
+                            removed += multiplicity;
+                            multiplicity = 0;
+                        }
+                    }
+                }
+            }
+            m_edge_count -= removed / 2;
+            m_sketch.reset();
+            return;
+        }
+
+        for (size_t p = 0; p < partition_count(); p++) {
+            Partition& partition = m_partitions[p];
+            for (Node node = 0; node < partition.table.size(); node++) {
+                for (uint64_t base = 0; base < 4; base++) {
+                    const uint32_t multiplicity = partition.out_edges[node][base];
+                    if (multiplicity == 0 || multiplicity >= min_count) {
+                        continue;
+                    }
+                    Kmer<Words> target = partition.table.kmer(node);
+                    target.push(base, m_k);
+                    const Node to = find(target);
+                    m_partitions[partition_of_node(to)].degrees[to - m_offsets[partition_of_node(to)]].in -=
+                        multiplicity;
+                    partition.out_edges[node][base] = 0;
+                    partition.degrees[node].out -= multiplicity;
+                    m_edge_count -= multiplicity;
+                }
+            }
+        }
+        m_sketch.reset();
+    }
+
+    // memory of the sketch of filter() until prune()
+    [[nodiscard]] size_t filter_memory() const { return m_sketch ? m_sketch->memory() : 0; }
+
+    [[nodiscard]] size_t k() const { return m_k; }
+
+    [[nodiscard]] size_t node_count() const { return m_offsets.back(); }
+
+    [[nodiscard]] size_t edge_count() const { return m_edge_count; }
+
+    [[nodiscard]] const Kmer<Words>& kmer(Node node) const {
+        const size_t p = partition_of_node(node);
+        return m_partitions[p].table.kmer(node - m_offsets[p]);
+    }
+
+    // the k-mer of the node, or its reverse complement
+    [[nodiscard]] std::string sequence(Node node, bool reverse = false) const {
+        return reverse ? kmer(node).reverse_complement(m_k).to_string(m_k) : kmer(node).to_string(m_k);
+    }
+
+    // multiplicity of the edges appending A, C, G and T, with Canonical followed by the ones appending them
+    // to the reverse complement
+    [[nodiscard]] const std::array<uint32_t, edge_slots>& out_edges(Node node) const {
+        const size_t p = partition_of_node(node);
+        return m_partitions[p].out_edges[node - m_offsets[p]];
+    }
+
+    [[nodiscard]] uint32_t in_degree(Node node) const {
+        static_assert(!Canonical, "a bidirected graph has no in-degrees");
+        const size_t p = partition_of_node(node);
+        return m_partitions[p].degrees[node - m_offsets[p]].in;
+    }
+
+    [[nodiscard]] uint32_t out_degree(Node node) const {
+        static_assert(!Canonical, "a bidirected graph has no out-degrees");
+        const size_t p = partition_of_node(node);
+        return m_partitions[p].degrees[node - m_offsets[p]].out;
+    }
+
+    // node of the k-mer (or with Canonical of its reverse complement) or npos
+    [[nodiscard]] Node find(const Kmer<Words>& kmer) const {
+        if constexpr (Canonical) {
+            return locate(std::min(kmer, kmer.reverse_complement(m_k)));
+        }
+        return locate(kmer);
+    }
+
+    // target of the edge appending the base
+    [[nodiscard]] Node next(Node node, uint64_t base) const {
+        Kmer<Words> kmer = this->kmer(node);
+        kmer.push(base, m_k);
+        return find(kmer);
+    }
+
+    // resolves every distinct edge to its target node once, so walks need no more k-mer lookups.
+    // With Canonical, every node is in the adjacency twice, see Adjacency
+    [[nodiscard]] Adjacency adjacency() const {
+        constexpr size_t sides = Canonical ? 2 : 1;
+        Adjacency result;
+        result.offsets.reserve(sides * node_count() + 1);
+        result.last_base.reserve(sides * node_count());
+        if constexpr (!Canonical) {
+            result.in_degree.reserve(node_count());
+            result.out_degree.reserve(node_count());
+        }
+        result.offsets.push_back(0);
+        for (size_t p = 0; p < partition_count(); p++) {
+            const Partition& partition = m_partitions[p];
+            for (Node node = 0; node < partition.table.size(); node++) {
+                const Kmer<Words>& kmer = partition.table.kmer(node);
+                const auto& edges       = partition.out_edges[node];
+                if constexpr (Canonical) {
+                    const Kmer<Words> reverse = kmer.reverse_complement(m_k);
+                    for (size_t side = 0; side < 2; side++) {
+                        const Kmer<Words>& from    = side == 0 ? kmer : reverse;
+                        const Kmer<Words>& flipped = side == 0 ? reverse : kmer;
+                        for (uint64_t base = 0; base < 4; base++) {
+                            if (edges[4 * side + base] > 0) {
+                                Kmer<Words> target = from;
+                                target.push(base, m_k);
+                                Kmer<Words> target_reverse = flipped;
+                                target_reverse.push_front(3 - base, m_k);
+                                const bool backwards = target_reverse < target;
+                                result.targets.push_back(2 * locate(backwards ? target_reverse : target) + backwards);
+                                result.multiplicity.push_back(edges[4 * side + base]);
+                            }
+                        }
+                        result.offsets.push_back(static_cast<uint32_t>(result.targets.size()));
+                        result.last_base.push_back(decode_base(from.base_from_end(0)));
+                    }
+                } else {
+                    for (uint64_t base = 0; base < edges.size(); base++) {
+                        if (edges[base] > 0) {
+                            Kmer<Words> target = kmer;
+                            target.push(base, m_k);
+                            result.targets.push_back(locate(target));
+                            result.multiplicity.push_back(edges[base]);
+                        }
+                    }
+                    result.offsets.push_back(static_cast<uint32_t>(result.targets.size()));
+                    result.last_base.push_back(decode_base(kmer.base_from_end(0)));
+                    result.in_degree.push_back(partition.degrees[node].in);
+                    result.out_degree.push_back(partition.degrees[node].out);
+                }
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] size_t memory() const {
+        size_t result = 0;
+        for (size_t p = 0; p < partition_count(); p++) {
+            result += m_partitions[p].table.memory() +
+                      m_partitions[p].out_edges.capacity() * sizeof(std::array<uint32_t, edge_slots>) +
+                      m_partitions[p].degrees.capacity() * sizeof(Degrees);
+        }
+        return result;
+    }
+
+private:
+    struct Degrees {
+        uint32_t in{0};
+        uint32_t out{0};
+    };
+
+    struct Partition {
+        std::mutex mutex;
+        KmerTable<Words> table;
+        std::vector<std::array<uint32_t, edge_slots>> out_edges;
+        // only without Canonical
+        std::vector<Degrees> degrees;
+    };
+
+    // marks a missing edge of an Entry
+    static constexpr uint8_t no_edge = 8;
+
+    // a k-mer of a read with the edges to the next and from the previous one in the read.
+    // out is the base the out-edge appends, in the one the in-edge prepends; with Canonical both are
+    // edge slots of the node instead
+    struct Entry {
+        Kmer<Words> kmer;
+        size_t hash;
+        uint8_t out;
+        uint8_t in;
+    };
+
+    // node of the k-mer as it is stored
+    [[nodiscard]] Node locate(const Kmer<Words>& kmer) const {
+        const size_t hash  = kmer.hash();
+        const size_t p     = partition_of(hash);
+        const Node in_part = m_partitions[p].table.find(kmer, hash);
+        return in_part == npos ? npos : m_offsets[p] + in_part;
+    }
+
+    [[nodiscard]] size_t partition_count() const { return size_t{1} << m_partition_bits; }
+
+    // the table picks slots by the low bits of the hash, the partition is told by the high ones
+    [[nodiscard]] size_t partition_of(size_t hash) const {
+        return m_partition_bits == 0 ? 0 : hash >> (64 - m_partition_bits);
+    }
+
+    [[nodiscard]] size_t partition_of_node(Node node) const {
+        return static_cast<size_t>(std::upper_bound(m_offsets.begin(), m_offsets.end(), node) - m_offsets.begin()) - 1;
+    }
+
+    static constexpr size_t reads_per_chunk = 1024;
+
+    // fill_chunk(chunk) appends the next reads to the empty chunk, leaving it empty once all are taken
+
+    template <class Reads>
+    static auto range_chunks(const Reads& reads, size_t count, std::atomic<size_t>& next_chunk) {
+        return [&reads, count, &next_chunk](std::vector<std::string_view>& chunk) {
+            const size_t first = next_chunk.fetch_add(reads_per_chunk);
+            auto read          = std::next(std::begin(reads), static_cast<std::ptrdiff_t>(std::min(first, count)));
+            for (size_t i = first; i < std::min(count, first + reads_per_chunk); i++, ++read) {
+                chunk.emplace_back(*read);
+            }
+        };
+    }
+
+    template <class Reader>
+    static auto stream_chunks(Reader& reader, std::mutex& mutex) {
+        return [&reader, &mutex](std::vector<std::string_view>& chunk) {
+            std::lock_guard lock(mutex);
+            std::string_view read;
+            while (chunk.size() < reads_per_chunk && reader.next(read)) {
+                chunk.push_back(read);
+            }
+        };
+    }
+
+    // runs work() on the calling thread and threads - 1 others
+    template <class Work>
+    static void run(Work&& work, size_t threads) {
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; t++) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    template <class FillChunk>
+    void count_chunks(FillChunk&& fill_chunk, size_t threads) {
+        run(
+            [&] {
+                std::vector<std::string_view> chunk;
+                chunk.reserve(reads_per_chunk);
+                for (fill_chunk(chunk); !chunk.empty(); chunk.clear(), fill_chunk(chunk)) {
+                    for (const std::string_view read : chunk) {
+                        roll(read, [this](const Kmer<Words>&, size_t, uint8_t out, uint8_t, uint64_t key) {
+                            if (out != no_edge) {
+                                m_sketch->add(key);
+                            }
+                        });
+                    }
+                }
+            },
+            threads);
+    }
+
+    // scans the reads of fill_chunk on threads workers
+    template <class FillChunk>
+    void add_chunks(FillChunk&& fill_chunk, size_t threads) {
+        constexpr size_t buffer_size = 1024;
+        std::atomic<size_t> edge_count{0};
+        const auto work = [&] {
+            std::vector<std::vector<Entry>> buffers(partition_count());
+            size_t edges     = 0;
+            const auto flush = [&](size_t p) {
+                Partition& partition = m_partitions[p];
+                std::lock_guard lock(partition.mutex);
+                for (const Entry& entry : buffers[p]) {
+                    edges += add(partition, entry);
+                }
+                buffers[p].clear();
+            };
+
+            std::vector<std::string_view> chunk;
+            chunk.reserve(reads_per_chunk);
+            for (fill_chunk(chunk); !chunk.empty(); chunk.clear(), fill_chunk(chunk)) {
+                for (const std::string_view read : chunk) {
+                    scan(read, [&](const Kmer<Words>& kmer, size_t hash, uint8_t out, uint8_t in) {
+                        const size_t p = partition_of(hash);
+                        buffers[p].push_back(Entry{kmer, hash, out, in});
+                        if (buffers[p].size() == buffer_size) {
+                            flush(p);
+                        }
+                    });
+                }
+            }
+            for (size_t p = 0; p < buffers.size(); p++) {
+                flush(p);
+            }
+            edge_count += edges;
+        };
+
+        run(work, threads);
+        m_edge_count += edge_count;
+        update_offsets();
+    }
+
+    // calls visit(kmer, hash, out, in, key) for every k-mer of the read as it is stored, with out and in
+    // as in Entry and no_edge at the ends of runs of ACGT bases. key hashes the (k+1)-mer of the out-edge,
+    // with Canonical alike on both strands. Line breaks are skipped, they only wrap FASTA records
+    template <class Visit>
+    void roll(std::string_view read, Visit&& visit) const {
+        // the k-mer of the read and its reverse complement roll along together
+        Kmer<Words> forward;
+        Kmer<Words> reverse;
+        size_t valid = 0;
+        // the previous k-mer, waiting for its out-edge
+        Kmer<Words> node;
+        size_t hash  = 0;
+        bool flipped = false;
+        uint8_t in   = no_edge;
+        bool pending = false;
+        for (const char c : read) {
+            const int code = encode_base(c);
+            if (code < 0) {
+                if (c == '\n' || c == '\r') {
+                    continue;
+                }
+                if (pending) {
+                    visit(node, hash, no_edge, in, uint64_t{0});
+                }
+                pending = false;
+                valid   = 0;
+                continue;
+            }
+            const auto base        = static_cast<uint8_t>(code);
+            const uint64_t dropped = forward.base_from_end(m_k - 1);
+            forward.push(base, m_k);
+            if constexpr (Canonical) {
+                reverse.push_front(3 - base, m_k);
+            }
+            if (++valid < m_k) {
+                continue;
+            }
+
+            const bool next_flipped = Canonical && reverse < forward;
+            const Kmer<Words>& next = next_flipped ? reverse : forward;
+            const size_t next_hash  = next.hash();
+            uint8_t next_in         = no_edge;
+            if (pending) {
+                const auto out = static_cast<uint8_t>(flipped ? 4 + base : base);
+                uint64_t key   = edge_hash(hash, out);
+                if constexpr (Canonical) {
+                    next_in = static_cast<uint8_t>((next_flipped ? 0 : 4) + 3 - dropped);
+                    key     = std::min(key, edge_hash(next_hash, next_in));
+                } else {
+                    next_in = static_cast<uint8_t>(dropped);
+                }
+                visit(node, hash, out, in, key);
+            }
+            node    = next;
+            hash    = next_hash;
+            flipped = next_flipped;
+            in      = next_in;
+            pending = true;
+        }
+        if (pending) {
+            visit(node, hash, no_edge, in, uint64_t{0});
+        }
+    }
+
+    // the (k+1)-mer as the sketch sees it, mixed again so its bits are independent of the k-mer's slot and partition
+    static uint64_t edge_hash(size_t hash, uint8_t out) {
+        uint64_t h = hash ^ (uint64_t{out} + 1) * 0x9e3779b97f4a7c15;
+        h          = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+        h          = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+        return h ^ (h >> 31);
+    }
+
+    // calls sink(kmer, hash, out, in) for every k-mer of the read with an edge, out and in as in Entry.
+    // Edges the filter rejects are left out like the ones across other characters than ACGT
+    template <class Sink>
+    void scan(std::string_view read, Sink&& sink) const {
+        // the edge into the k-mer was kept
+        bool kept = false;
+        roll(read, [&](const Kmer<Words>& kmer, size_t hash, uint8_t out, uint8_t in, uint64_t key) {
+            if (out != no_edge && m_sketch && m_sketch->estimate(key) < m_min_count) {
+                out = no_edge;
+            }
+            if (!kept) {
+                in = no_edge;
+            }
+            kept = out != no_edge;
+            if (out != no_edge || in != no_edge) {
+                sink(kmer, hash, out, in);
+            }
+        });
+    }
+
+    // returns the number of edges added
+    static size_t add(Partition& partition, const Entry& entry) {
+        const Node node = partition.table.insert(entry.kmer, entry.hash);
+        if (node == partition.out_edges.size()) {
+            partition.out_edges.emplace_back();
+            if constexpr (!Canonical) {
+                partition.degrees.emplace_back();
+            }
+        }
+        if constexpr (Canonical) {
+            // the edge from the previous k-mer is also one of this node's slots
+            if (entry.in != no_edge) {
+                partition.out_edges[node][entry.in]++;
+            }
+        } else {
+            partition.degrees[node].in += entry.in != no_edge;
+        }
+        if (entry.out == no_edge) {
+            return 0;
+        }
+        partition.out_edges[node][entry.out]++;
+        if constexpr (!Canonical) {
+            partition.degrees[node].out++;
+        }
+        return 1;
+    }
+
+    void update_offsets() {
+        for (size_t p = 0; p < partition_count(); p++) {
+            m_offsets[p + 1] = m_offsets[p] + static_cast<Node>(m_partitions[p].table.size());
+        }
+    }
+
+    size_t m_k;
+    size_t m_edge_count{0};
+    std::unique_ptr<CountMinSketch> m_sketch;
+    uint32_t m_min_count{1};
+    size_t m_partition_bits;
+    std::unique_ptr<Partition[]> m_partitions;
+    // first node of every partition followed by the node count
+    std::vector<Node> m_offsets;
+};
+
+}  // namespace genome
+
+#endif  // GA_GRAPH_HPP
@@ -0,0 +1,131 @@
+#ifndef GA_KMER_HPP
+#define GA_KMER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace genome {
+
+// k-mers are packed 2 bits per base, so one 64-bit word holds 32 bases
+constexpr size_t bases_per_word = 32;
+constexpr size_t max_words      = 4;
+constexpr size_t max_k          = bases_per_word * max_words;
+
+constexpr size_t words_for(size_t k) {
+    return (k + bases_per_word - 1) / bases_per_word;
+}
+
+// A, C, G, T (either case) to 0..3, anything else to -1
+constexpr int encode_base(char base) {
+    switch (base) {
+        case 'A':
+        case 'a':
+            return 0;
+        case 'C':
+        case 'c':
+            return 1;
+        case 'G':
+        case 'g':
+            return 2;
+        case 'T':
+        case 't':
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+constexpr char decode_base(uint64_t code) {
+    return "ACGT"[code & 3];
+}
+
+// k-mer as a 64 * Words bit number: the first base in the highest used bits of words[0],
+// the last one in the lowest bits of words[Words - 1]
+template <size_t Words>
+struct Kmer {
+    std::array<uint64_t, Words> words{};
+
+    // appends a base and drops the first one, k is the k-mer length
+    void push(uint64_t base, size_t k) {
+        for (size_t i = 0; i + 1 < Words; i++) {
+            words[i] = words[i] << 2 | words[i + 1] >> 62;
+        }
+        words[Words - 1] = words[Words - 1] << 2 | base;
+
+        const size_t top_bits = 2 * (k - bases_per_word * (Words - 1));
+        if (top_bits < 64) {
+            words[0] &= (uint64_t{1} << top_bits) - 1;
+        }
+    }
+
+    // prepends a base and drops the last one, the reverse complement of a k-mer rolls this way
+    // while the k-mer itself rolls with push
+    void push_front(uint64_t base, size_t k) {
+        for (size_t i = Words - 1; i > 0; i--) {
+            words[i] = words[i] >> 2 | words[i - 1] << 62;
+        }
+        words[0] >>= 2;
+
+        const size_t first = k - 1;
+        words[Words - 1 - first / bases_per_word] |= base << 2 * (first % bases_per_word);
+    }
+
+    [[nodiscard]] Kmer reverse_complement(size_t k) const {
+        // complementing and reversing the 2-bit groups of every word reverses all 32 * Words bases,
+        // which leaves the k-mer in the highest bits
+        Kmer result;
+        for (size_t i = 0; i < Words; i++) {
+            uint64_t word = ~words[Words - 1 - i];
+            word          = (word >> 2 & 0x3333333333333333) | (word & 0x3333333333333333) << 2;
+            word          = (word >> 4 & 0x0f0f0f0f0f0f0f0f) | (word & 0x0f0f0f0f0f0f0f0f) << 4;
+            result.words[i] = __builtin_bswap64(word);
+        }
+        const size_t shift = 2 * (bases_per_word * Words - k);
+        const size_t whole = shift / 64;
+        const size_t bits  = shift % 64;
+        for (size_t i = Words; i-- > 0;) {
+            uint64_t word = i >= whole ? result.words[i - whole] >> bits : 0;
+            if (bits > 0 && i > whole) {
+                word |= result.words[i - whole - 1] << (64 - bits);
+            }
+            result.words[i] = word;
+        }
+        return result;
+    }
+
+    // base at position i counting from the end, 0 is the last base
+    [[nodiscard]] uint64_t base_from_end(size_t i) const {
+        return words[Words - 1 - i / bases_per_word] >> 2 * (i % bases_per_word) & 3;
+    }
+
+    [[nodiscard]] size_t hash() const {
+        uint64_t h = 0x9e3779b97f4a7c15;
+        for (uint64_t word : words) {
+            // splitmix64 finalizer over the running value
+            h ^= word;
+            h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+            h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+            h ^= h >> 31;
+        }
+        return static_cast<size_t>(h);
+    }
+
+    [[nodiscard]] std::string to_string(size_t k) const {
+        std::string result(k, 'A');
+        for (size_t i = 0; i < k; i++) {
+            result[k - 1 - i] = decode_base(base_from_end(i));
+        }
+        return result;
+    }
+
+    bool operator==(const Kmer& other) const { return words == other.words; }
+    bool operator!=(const Kmer& other) const { return words != other.words; }
+    // the order of the k-mers as strings, for picking the canonical one of a k-mer and its reverse complement
+    bool operator<(const Kmer& other) const { return words < other.words; }
+};
+
+}  // namespace genome
+
+#endif  // GA_KMER_HPP
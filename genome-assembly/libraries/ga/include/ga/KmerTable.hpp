@@ -0,0 +1,108 @@
+#ifndef GA_KMER_TABLE_HPP
+#define GA_KMER_TABLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ga/Kmer.hpp"
+
+namespace genome {
+
+// flat open-addressing table numbering distinct k-mers 0, 1, 2, ... in insertion order.
+// A slot keeps the id and the high half of the hash, so probing past other k-mers
+// rarely touches the k-mer array, which is indexed by id
+template <size_t Words>
+class KmerTable {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    explicit KmerTable(size_t expected = 0) { reserve(expected); }
+
+    // id of the k-mer, inserting it under the next id if it is new
+    uint32_t insert(const Kmer<Words>& kmer) { return insert(kmer, kmer.hash()); }
+
+    // the same with the hash already computed
+    uint32_t insert(const Kmer<Words>& kmer, size_t hash) {
+        if ((kmers.size() + 1) * 2 > slots.size()) {
+            reserve(std::max<size_t>(kmers.size() + 1, slots.size()));
+        }
+        const auto tag    = static_cast<uint32_t>(hash >> 32);
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.id == npos) {
+                slot.id  = static_cast<uint32_t>(kmers.size());
+                slot.tag = tag;
+                kmers.push_back(kmer);
+                return slot.id;
+            }
+            if (slot.tag == tag && kmers[slot.id] == kmer) {
+                return slot.id;
+            }
+        }
+    }
+
+    // id of the k-mer or npos
+    [[nodiscard]] uint32_t find(const Kmer<Words>& kmer) const { return find(kmer, kmer.hash()); }
+
+    [[nodiscard]] uint32_t find(const Kmer<Words>& kmer, size_t hash) const {
+        if (slots.empty()) {
+            return npos;
+        }
+        const auto tag    = static_cast<uint32_t>(hash >> 32);
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.id == npos) {
+                return npos;
+            }
+            if (slot.tag == tag && kmers[slot.id] == kmer) {
+                return slot.id;
+            }
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return kmers.size(); }
+
+    [[nodiscard]] const Kmer<Words>& kmer(uint32_t id) const { return kmers[id]; }
+
+    // makes room for count k-mers without rehashing, keeping the load factor at most 1/2
+    void reserve(size_t count) {
+        size_t capacity = 16;
+        while (capacity < 2 * count) {
+            capacity *= 2;
+        }
+        if (capacity <= slots.size()) {
+            return;
+        }
+        kmers.reserve(count);
+        slots.assign(capacity, Slot{});
+        mask = capacity - 1;
+        for (uint32_t id = 0; id < kmers.size(); id++) {
+            const size_t hash = kmers[id].hash();
+            size_t i          = hash & mask;
+            while (slots[i].id != npos) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = Slot{id, static_cast<uint32_t>(hash >> 32)};
+        }
+    }
+
+    [[nodiscard]] size_t memory() const {
+        return slots.capacity() * sizeof(Slot) + kmers.capacity() * sizeof(Kmer<Words>);
+    }
+
+private:
+    struct Slot {
+        uint32_t id{npos};
+        uint32_t tag{0};
+    };
+
+    std::vector<Slot> slots;
+    std::vector<Kmer<Words>> kmers;
+    size_t mask{0};
+};
+
+}  // namespace genome
+
+#endif  // GA_KMER_TABLE_HPP
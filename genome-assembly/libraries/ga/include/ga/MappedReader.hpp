@@ -0,0 +1,47 @@
+#ifndef GA_MAPPED_READER_HPP
+#define GA_MAPPED_READER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace genome {
+
+// reads sequences from a memory-mapped FASTA, FASTQ or plain text file, told apart like in SequenceReader.
+// The sequences are views into the mapping, valid while the reader lives, so nothing is copied.
+// A FASTA sequence spanning several lines keeps its line breaks, which DeBruijnGraph skips
+class MappedReader {
+public:
+    // throws std::system_error if the file cannot be opened or mapped
+    explicit MappedReader(const std::string& path);
+    ~MappedReader();
+
+    MappedReader(const MappedReader&)            = delete;
+    MappedReader& operator=(const MappedReader&) = delete;
+
+    // false once the file is over
+    bool next(std::string_view& sequence);
+
+    // starts over at the first sequence
+    void rewind() { m_position = m_start; }
+
+    // size of the file in bytes
+    [[nodiscard]] size_t size() const { return m_size; }
+
+private:
+    enum class Format { plain, fasta, fastq };
+
+    bool read_line(std::string_view& line);
+    // position of the first c at or after from, or m_size
+    [[nodiscard]] size_t find(char c, size_t from) const;
+
+    const char* m_data{nullptr};
+    size_t m_size{0};
+    size_t m_position{0};
+    size_t m_start{0};
+    Format m_format{Format::plain};
+};
+
+}  // namespace genome
+
+#endif  // GA_MAPPED_READER_HPP
@@ -0,0 +1,31 @@
+#ifndef GA_SEQUENCE_READER_HPP
+#define GA_SEQUENCE_READER_HPP
+
+#include <istream>
+#include <string>
+
+namespace genome {
+
+// reads sequences one by one from a FASTA or FASTQ stream, or from plain text with one sequence per line.
+// The format is told by the first character: '>' for FASTA, where a sequence may span several lines,
+// '@' for FASTQ with four lines per record
+class SequenceReader {
+public:
+    explicit SequenceReader(std::istream& input);
+
+    // false once the input is over
+    bool next(std::string& sequence);
+
+private:
+    enum class Format { plain, fasta, fastq };
+
+    bool read_line(std::string& line);
+
+    std::istream& m_input;
+    Format m_format{Format::plain};
+    std::string m_line;
+};
+
+}  // namespace genome
+
+#endif  // GA_SEQUENCE_READER_HPP
@@ -0,0 +1,43 @@
+#ifndef GA_SIMULATOR_HPP
+#define GA_SIMULATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace genome {
+
+// synthetic genomes and sequencing reads for benchmarks, the same seed gives the same result
+
+// every base drawn uniformly
+std::string random_genome(size_t length, uint64_t seed);
+
+// random genome in which copies of units random repeats of repeat_length bases cover about half of it,
+// std::invalid_argument is thrown if units or repeat_length is 0
+std::string repeat_genome(size_t length, size_t repeat_length, size_t units, uint64_t seed);
+
+std::string reverse_complement(std::string_view sequence);
+
+struct ReadSimulation {
+    size_t length{100};
+    // bases read per genome base
+    double coverage{10};
+    // probability of a base being read as one of the 3 others
+    double error_rate{0};
+    // half of the reads, picked at random, are reverse complemented
+    bool both_strands{false};
+    uint64_t seed{1};
+};
+
+// reads from uniformly random positions
+std::vector<std::string> sample_reads(const std::string& genome, const ReadSimulation& simulation);
+
+// error-free reads overlapping by exactly k bases, so every (k+1)-mer occurrence of the genome is read once
+// and the genome is an Euler path of their de Bruijn graph
+std::vector<std::string> tile_reads(const std::string& genome, size_t length, size_t k);
+
+}  // namespace genome
+
+#endif  // GA_SIMULATOR_HPP
@@ -1,91 +1,481 @@
 #include "ga/Genome.hpp"
 
-std::unordered_map<std::string_view, std::vector<std::string_view>> make_graph(size_t k,
-                                                                               const std::vector<std::string>& reads) {
-    std::unordered_map<std::string_view, std::vector<std::string_view>> graph;
-    const size_t read_size = reads.front().size();
-
-    for (const auto& read : reads) {
-        for (size_t i = 0; i + k < read_size; i++) {
-            std::string_view from = std::string_view{read}.substr(i, k);
-            std::string_view to   = std::string_view{read}.substr(i + 1, k);
-            graph[from].push_back(to);
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+#include "ga/Graph.hpp"
+#include "ga/MappedReader.hpp"
+#include "ga/SequenceReader.hpp"
+
+// the reads are passed to the graph to be added, and before to be counted if rare (k+1)-mers are filtered
+enum class Pass { count, add };
+
+struct Abundance {
+    // (k+1)-mers seen less often are dropped, 1 keeps all
+    uint32_t min_count;
+    // counters of the sketch of the counting pass, 0 if the reads can only be passed once
+    size_t counters;
+};
+
+// times consecutive stages: each lap adds the time since the previous one to a field of the stats, if any
+class Laps {
+public:
+    explicit Laps(genome::AssemblyStats* stats) : m_stats(stats) {
+        if (m_stats != nullptr) {
+            *m_stats = genome::AssemblyStats{};
+        }
+    }
+
+    void operator()(double genome::AssemblyStats::*stage) {
+        const auto now = std::chrono::steady_clock::now();
+        if (m_stats != nullptr) {
+            m_stats->*stage += std::chrono::duration<double, std::milli>(now - m_last).count();
         }
+        m_last = now;
     }
 
+    template <class Graph>
+    void record(const Graph& graph) {
+        if (m_stats != nullptr) {
+            m_stats->nodes        = graph.node_count();
+            m_stats->edges        = graph.edge_count();
+            m_stats->graph_memory = graph.memory();
+        }
+    }
+
+private:
+    genome::AssemblyStats* m_stats;
+    std::chrono::steady_clock::time_point m_last{std::chrono::steady_clock::now()};
+};
+
+// pass_reads(graph, pass) passes the reads on the given number of threads
+template <size_t Words, bool Canonical = false, class PassReads>
+genome::DeBruijnGraph<Words, Canonical> make_graph(size_t k, PassReads&& pass_reads, size_t threads,
+                                                   Abundance abundance, Laps& lap) {
+    // many more partitions than threads keep the workers off each other's locks
+    genome::DeBruijnGraph<Words, Canonical> graph(k, threads > 1 ? 8 : 0);
+    if (abundance.min_count > 1 && abundance.counters > 0) {
+        graph.filter(abundance.counters, abundance.min_count);
+        pass_reads(graph, Pass::count);
+        lap(&genome::AssemblyStats::count_ms);
+    }
+    pass_reads(graph, Pass::add);
+    if (abundance.min_count > 1) {
+        graph.prune(abundance.min_count);
+    }
+    lap(&genome::AssemblyStats::build_ms);
+    lap.record(graph);
     return graph;
 }
 
-std::string_view start_node(std::unordered_map<std::string_view, std::vector<std::string_view>>& graph) {
-    std::string_view start = graph.begin()->first;
-    std::unordered_map<std::string_view, int> in_degree;
-    std::unordered_map<std::string_view, int> out_degree;
+// an Euler path starts at the one node with an out-edge to spare, or anywhere on a cycle if all are balanced
+uint32_t start_node(const genome::Adjacency& graph) {
+    constexpr uint32_t none = UINT32_MAX;
+    uint32_t start          = none;
+    uint32_t first_edged    = none;
+    size_t starts        = 0;
+    size_t ends          = 0;
 
-    for (const auto& [from, to] : graph) {
-        for (const auto& node : to) {
-            in_degree[node]++;
-            out_degree[from]++;
+    for (uint32_t node = 0; node < graph.node_count(); node++) {
+        const int64_t power = int64_t{graph.out_degree[node]} - int64_t{graph.in_degree[node]};
+        if (power == 1) {
+            start = node;
+            starts++;
+        } else if (power == -1) {
+            ends++;
+        } else if (power != 0) {
+            throw std::runtime_error("genome::assembly: the de Bruijn graph has no Euler path, a node has " +
+                                     std::to_string(graph.out_degree[node]) + " out-edges and " +
+                                     std::to_string(graph.in_degree[node]) + " in-edges");
+        }
+        if (first_edged == none && graph.out_degree[node] > 0) {
+            first_edged = node;
         }
     }
 
-    for (const auto& el : graph) {
-        int power = out_degree[el.first] - in_degree[el.first];
-
-        if (power > 0 && power % 2 == 1) {
-            start = el.first;
-            break;
-        }
+    if (starts != ends || starts > 1) {
+        throw std::runtime_error("genome::assembly: the de Bruijn graph has no Euler path, " + std::to_string(starts) +
+                                 " nodes have an extra out-edge and " + std::to_string(ends) + " an extra in-edge");
     }
 
-    return start;
+    return starts == 1 ? start : first_edged;
 }
 
-std::vector<std::string_view> euler(std::unordered_map<std::string_view, std::vector<std::string_view>>& graph) {
-    std::string_view start = start_node(graph);
-    std::vector<std::string_view> euler_path;
+// Hierholzer's walk: every node keeps a cursor to its next unused edge, so each edge is taken once in O(1)
+std::vector<uint32_t> euler(const genome::Adjacency& graph, size_t edge_count, uint32_t start) {
+    std::vector<uint32_t> euler_path;
+    euler_path.reserve(edge_count + 1);
 
-    std::vector<std::string_view> stack = {start};
-    while (!stack.empty()) {
-        const std::string_view node = stack.back();
-        stack.pop_back();
+    std::vector<uint32_t> cursor(graph.offsets.begin(), graph.offsets.end() - 1);
+    std::vector<uint32_t> remaining = graph.multiplicity;
 
-        auto& edges = graph[node];
-        if (!edges.empty()) {
-            stack.push_back(node);
-            const std::string_view next = edges.front();
+    std::vector<uint32_t> stack = {start};
+    while (!stack.empty()) {
+        const uint32_t node = stack.back();
+        const uint32_t edge = cursor[node];
 
-            edges.erase(edges.begin());
-            stack.push_back(next);
+        if (edge < graph.offsets[node + 1]) {
+            if (--remaining[edge] == 0) {
+                cursor[node]++;
+            }
+            stack.push_back(graph.targets[edge]);
         } else {
+            stack.pop_back();
             euler_path.push_back(node);
         }
     }
 
+    // with balanced degrees the walk only misses edges in other connected components
+    if (euler_path.size() != edge_count + 1) {
+        throw std::runtime_error("genome::assembly: the de Bruijn graph is not connected, the Euler path covers " +
+                                 std::to_string(euler_path.size() - 1) + " of " + std::to_string(edge_count) +
+                                 " edges");
+    }
+
     return euler_path;
 }
 
-std::string merge_genome(std::vector<std::string_view>& euler_path) {
+template <size_t Words>
+std::string merge_genome(const genome::DeBruijnGraph<Words>& graph, const genome::Adjacency& adjacency,
+                         std::vector<uint32_t>& euler_path) {
     std::reverse(euler_path.begin(), euler_path.end());
-    std::string result = static_cast<std::string>(euler_path[0]);
+    std::string result = graph.sequence(euler_path[0]);
+    result.resize(graph.k() + euler_path.size() - 1);
 
+    char* out = result.data() + graph.k();
     for (size_t i = 1; i < euler_path.size(); i++) {
-        result += euler_path[i].back();
+        *out++ = adjacency.last_base[euler_path[i]];
+    }
+
+    return result;
+}
+
+template <size_t Words, class PassReads>
+std::string assemble(size_t k, PassReads&& pass_reads, size_t threads, Abundance abundance,
+                     genome::AssemblyStats* stats) {
+    Laps lap(stats);
+    const genome::DeBruijnGraph<Words> graph = make_graph<Words>(k, pass_reads, threads, abundance, lap);
+    if (graph.edge_count() == 0) {
+        return "";
+    }
+    const genome::Adjacency adjacency = graph.adjacency();
+    lap(&genome::AssemblyStats::adjacency_ms);
+    const uint32_t start = start_node(adjacency);
+    lap(&genome::AssemblyStats::start_ms);
+    std::vector<uint32_t> genome = euler(adjacency, graph.edge_count(), start);
+    lap(&genome::AssemblyStats::walk_ms);
+
+    std::string result = merge_genome(graph, adjacency, genome);
+    lap(&genome::AssemblyStats::merge_ms);
+    return result;
+}
+
+// unitigs are the maximal paths whose inner nodes have one distinct in-edge and one distinct out-edge.
+// All but isolated cycles start with an edge out of a branching node, so they are spelled independently
+// on the given threads; each inner node lies on exactly one of them.
+// A canonical graph holds every unitig on both strands, only the smaller of the two node sequences is kept
+template <class Graph>
+std::vector<std::string> compact(const Graph& graph, const genome::Adjacency& adjacency, size_t threads) {
+    const size_t node_count = adjacency.node_count();
+    // distinct in-edges, counting stops at 2
+    std::vector<uint8_t> in_edges(node_count);
+    for (const uint32_t target : adjacency.targets) {
+        in_edges[target] = static_cast<uint8_t>(std::min(in_edges[target] + 1, 2));
+    }
+    const auto inner = [&](uint32_t node) {
+        return in_edges[node] == 1 && adjacency.offsets[node + 1] - adjacency.offsets[node] == 1;
+    };
+
+    struct Seed {
+        uint32_t source;
+        uint32_t edge;
+    };
+    std::vector<Seed> seeds;
+    for (uint32_t node = 0; node < node_count; node++) {
+        if (!inner(node)) {
+            for (uint32_t edge = adjacency.offsets[node]; edge < adjacency.offsets[node + 1]; edge++) {
+                seeds.push_back(Seed{node, edge});
+            }
+        }
+    }
+
+    // the k-mer of the first node followed by the last base of every node on the path
+    const auto spell = [&](uint32_t first, const std::vector<uint32_t>& path) {
+        std::string contig = Graph::canonical ? graph.sequence(first / 2, first % 2 == 1) : graph.sequence(first);
+        contig.resize(graph.k() + path.size());
+        char* out = contig.data() + graph.k();
+        for (const uint32_t node : path) {
+            *out++ = adjacency.last_base[node];
+        }
+        return contig;
+    };
+
+    // the path from first is the reverse complement of (path.back() ^ 1, ..., path.front() ^ 1, first ^ 1)
+    const auto reverse_is_smaller = [](uint32_t first, const std::vector<uint32_t>& path) {
+        const size_t length = path.size() + 1;
+        for (size_t i = 0; i < length; i++) {
+            const uint32_t node    = i == 0 ? first : path[i - 1];
+            const uint32_t reverse = (i + 1 == length ? first : path[length - 2 - i]) ^ 1;
+            if (node != reverse) {
+                return reverse < node;
+            }
+        }
+        return false;
+    };
+
+    std::vector<std::string> contigs(seeds.size());
+    // inner nodes reached from a seed, each one is written by a single thread
+    std::vector<uint8_t> visited(node_count);
+    constexpr size_t seeds_per_chunk = 1024;
+    std::atomic<size_t> next_chunk{0};
+    const auto work = [&] {
+        std::vector<uint32_t> path;
+        for (size_t first = next_chunk.fetch_add(seeds_per_chunk); first < seeds.size();
+             first        = next_chunk.fetch_add(seeds_per_chunk)) {
+            for (size_t i = first; i < std::min(seeds.size(), first + seeds_per_chunk); i++) {
+                path.clear();
+                uint32_t node = adjacency.targets[seeds[i].edge];
+                path.push_back(node);
+                while (inner(node)) {
+                    visited[node] = 1;
+                    node          = adjacency.targets[adjacency.offsets[node]];
+                    path.push_back(node);
+                }
+                if (!Graph::canonical || !reverse_is_smaller(seeds[i].source, path)) {
+                    contigs[i] = spell(seeds[i].source, path);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < std::min(threads, seeds.size()); t++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // inner nodes no seed reaches form cycles, spelled once around from their first node
+    std::vector<uint32_t> path;
+    for (uint32_t start = 0; start < node_count; start++) {
+        if (!inner(start) || visited[start]) {
+            continue;
+        }
+        path.clear();
+        uint32_t node = start;
+        do {
+            visited[node] = 1;
+            if (Graph::canonical) {
+                visited[node ^ 1] = 1;
+            }
+            node = adjacency.targets[adjacency.offsets[node]];
+            path.push_back(node);
+        } while (node != start);
+        contigs.push_back(spell(start, path));
+    }
+
+    if (Graph::canonical) {
+        contigs.erase(std::remove(contigs.begin(), contigs.end(), std::string()), contigs.end());
+    }
+    return contigs;
+}
+
+template <size_t Words, class PassReads>
+std::vector<std::string> contigs(size_t k, PassReads&& pass_reads, size_t threads, Abundance abundance,
+                                 bool canonical, genome::AssemblyStats* stats) {
+    Laps lap(stats);
+    const auto compact_graph = [&](const auto& graph) {
+        const genome::Adjacency adjacency = graph.adjacency();
+        lap(&genome::AssemblyStats::adjacency_ms);
+        std::vector<std::string> result = compact(graph, adjacency, threads);
+        lap(&genome::AssemblyStats::compact_ms);
+        return result;
+    };
+    if (canonical) {
+        return compact_graph(make_graph<Words, true>(k, pass_reads, threads, abundance, lap));
     }
+    return compact_graph(make_graph<Words>(k, pass_reads, threads, abundance, lap));
+}
 
+// calls f with std::integral_constant<size_t, Words>, k-mers take as few 64-bit words as k allows
+template <class F>
+auto with_words(size_t k, F&& f) {
+    switch (genome::words_for(k)) {
+        case 1:
+            return f(std::integral_constant<size_t, 1>{});
+        case 2:
+            return f(std::integral_constant<size_t, 2>{});
+        case 3:
+            return f(std::integral_constant<size_t, 3>{});
+        case 4:
+            return f(std::integral_constant<size_t, 4>{});
+        default:
+            throw std::invalid_argument("genome::assembly: k must not exceed " + std::to_string(genome::max_k));
+    }
+}
+
+size_t bases(const std::vector<std::string>& reads) {
+    size_t result = 0;
+    for (const std::string& read : reads) {
+        result += read.size();
+    }
     return result;
 }
 
+// the Euler path runs through a directed graph
+void check_directed(const genome::AssemblyOptions& options) {
+    if (options.canonical) {
+        throw std::invalid_argument("genome::assembly: canonical k-mers make a bidirected graph, use contigs");
+    }
+}
+
+// with an even k a palindromic k-mer is one node for both strands and its unitigs get lost
+void check_odd(size_t k, const genome::AssemblyOptions& options) {
+    if (options.canonical && k % 2 == 0) {
+        throw std::invalid_argument("genome::contigs: canonical k-mers need an odd k");
+    }
+}
+
+size_t thread_count(const genome::AssemblyOptions& options) {
+    return options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// input_bases sizes the sketch unless the options do, 0 for input that can only be read once
+Abundance abundance(const genome::AssemblyOptions& options, size_t input_bases) {
+    const size_t counters = options.sketch_counters > 0 ? options.sketch_counters : input_bases;
+    return Abundance{options.min_abundance, input_bases > 0 ? counters : 0};
+}
+
+auto pass_vector(const std::vector<std::string>& reads, size_t threads) {
+    return [&reads, threads](auto& graph, Pass pass) {
+        if (pass == Pass::count) {
+            graph.count_reads(reads, threads);
+        } else {
+            graph.add_reads(reads, threads);
+        }
+    };
+}
+
+// adds the reads of the stream in batches, so the stream is never held in memory as a whole.
+// It is read once, so there is no counting pass
+auto pass_stream(std::istream& input, size_t threads) {
+    return [&input, threads](auto& graph, Pass pass) {
+        if (pass == Pass::count) {
+            return;
+        }
+        constexpr size_t batch_size = 1 << 16;
+        genome::SequenceReader reader(input);
+        std::vector<std::string> batch(batch_size);
+        size_t count = 0;
+        while (true) {
+            const bool more = reader.next(batch[count]);
+            count += more;
+            if (!more || count == batch_size) {
+                batch.resize(count);
+                graph.add_reads(batch, threads);
+                if (!more) {
+                    return;
+                }
+                batch.resize(batch_size);
+                count = 0;
+            }
+        }
+    };
+}
+
+// the reads go straight from the mapping into the graph
+auto pass_mapped(genome::MappedReader& reader, size_t threads) {
+    return [&reader, threads](auto& graph, Pass pass) {
+        if (pass == Pass::count) {
+            graph.count_stream(reader, threads);
+            reader.rewind();
+        } else {
+            graph.add_stream(reader, threads);
+        }
+    };
+}
+
 namespace genome {
 
-std::string assembly(size_t k, const std::vector<std::string>& reads) {
+std::string assembly(size_t k, const std::vector<std::string>& reads, const AssemblyOptions& options) {
     if (k == 0 || reads.empty()) {
         return "";
     }
 
-    std::unordered_map<std::string_view, std::vector<std::string_view>> graph = make_graph(k, reads);
-    std::vector<std::string_view> genome                                      = euler(graph);
+    check_directed(options);
+    const size_t threads = thread_count(options);
+    return with_words(k, [&](auto words) {
+        return assemble<decltype(words)::value>(k, pass_vector(reads, threads), threads, abundance(options, bases(reads)), options.stats);
+    });
+}
+
+std::string assembly(size_t k, std::istream& input, const AssemblyOptions& options) {
+    if (k == 0) {
+        return "";
+    }
+
+    check_directed(options);
+    const size_t threads = thread_count(options);
+    return with_words(k, [&](auto words) {
+        return assemble<decltype(words)::value>(k, pass_stream(input, threads), threads, abundance(options, 0), options.stats);
+    });
+}
+
+std::string assembly(size_t k, MappedReader& reader, const AssemblyOptions& options) {
+    if (k == 0) {
+        return "";
+    }
+
+    check_directed(options);
+    const size_t threads = thread_count(options);
+    return with_words(k, [&](auto words) {
+        return assemble<decltype(words)::value>(k, pass_mapped(reader, threads), threads, abundance(options, reader.size()), options.stats);
+    });
+}
+
+std::vector<std::string> contigs(size_t k, const std::vector<std::string>& reads, const AssemblyOptions& options) {
+    if (k == 0 || reads.empty()) {
+        return {};
+    }
+
+    check_odd(k, options);
+    const size_t threads = thread_count(options);
+    return with_words(k, [&](auto words) {
+        return ::contigs<decltype(words)::value>(k, pass_vector(reads, threads), threads, abundance(options, bases(reads)), options.canonical, options.stats);
+    });
+}
+
+std::vector<std::string> contigs(size_t k, std::istream& input, const AssemblyOptions& options) {
+    if (k == 0) {
+        return {};
+    }
+
+    check_odd(k, options);
+    const size_t threads = thread_count(options);
+    return with_words(k, [&](auto words) {
+        return ::contigs<decltype(words)::value>(k, pass_stream(input, threads), threads, abundance(options, 0), options.canonical, options.stats);
+    });
+}
+
+std::vector<std::string> contigs(size_t k, MappedReader& reader, const AssemblyOptions& options) {
+    if (k == 0) {
+        return {};
+    }
 
-    return merge_genome(genome);
+    check_odd(k, options);
+    const size_t threads = thread_count(options);
+    return with_words(k, [&](auto words) {
+        return ::contigs<decltype(words)::value>(k, pass_mapped(reader, threads), threads, abundance(options, reader.size()), options.canonical, options.stats);
+    });
 }
 
 }  // namespace genome
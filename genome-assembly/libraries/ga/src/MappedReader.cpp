@@ -0,0 +1,138 @@
+#include "ga/MappedReader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <system_error>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace genome {
+
+MappedReader::MappedReader(const std::string& path) {
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+    }
+    struct stat status {};
+    if (::fstat(file, &status) != 0) {
+        const int error = errno;
+        ::close(file);
+        throw std::system_error(error, std::generic_category(), "cannot read " + path);
+    }
+    m_size = static_cast<size_t>(status.st_size);
+    // an empty file cannot be mapped and has nothing to read
+    if (m_size > 0) {
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED) {
+            const int error = errno;
+            ::close(file);
+            throw std::system_error(error, std::generic_category(), "cannot map " + path);
+        }
+        m_data = static_cast<const char*>(data);
+        ::madvise(data, m_size, MADV_SEQUENTIAL);
+    }
+    ::close(file);
+
+    while (m_position < m_size && std::isspace(static_cast<unsigned char>(m_data[m_position]))) {
+        m_position++;
+    }
+    m_start = m_position;
+    if (m_position < m_size && m_data[m_position] == '>') {
+        m_format = Format::fasta;
+    } else if (m_position < m_size && m_data[m_position] == '@') {
+        m_format = Format::fastq;
+    }
+}
+
+MappedReader::~MappedReader() {
+    if (m_data != nullptr) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+
+bool MappedReader::next(std::string_view& sequence) {
+    switch (m_format) {
+        case Format::plain:
+            while (read_line(sequence)) {
+                if (!sequence.empty()) {
+                    return true;
+                }
+            }
+            return false;
+        case Format::fastq: {
+            // header, sequence, '+' separator, quality
+            std::string_view line;
+            while (read_line(line)) {
+                if (line.empty()) {
+                    continue;
+                }
+                sequence            = {};
+                const bool complete = read_line(sequence) && read_line(line) && read_line(line);
+                return complete || !sequence.empty();
+            }
+            return false;
+        }
+        case Format::fasta: {
+            if (m_position >= m_size) {
+                return false;
+            }
+            std::string_view header;
+            if (m_data[m_position] == '>') {
+                read_line(header);
+            }
+            // '>' only starts headers, so the record runs up to the next one
+            const size_t end = find('>', m_position);
+            size_t last      = end;
+            while (last > m_position && std::isspace(static_cast<unsigned char>(m_data[last - 1]))) {
+                last--;
+            }
+            sequence   = std::string_view(m_data + m_position, last - m_position);
+            m_position = end;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MappedReader::read_line(std::string_view& line) {
+    if (m_position >= m_size) {
+        return false;
+    }
+    const size_t end = find('\n', m_position);
+    line             = std::string_view(m_data + m_position, end - m_position);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    m_position = end + 1;
+    return true;
+}
+
+size_t MappedReader::find(char c, size_t from) const {
+    size_t i = from;
+#if defined(__SSE2__)
+    // 16 bytes per comparison, the bit of the first match in the mask gives the position
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; i + 16 <= m_size; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_data + i));
+        const int mask      = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+#endif
+    for (; i < m_size; i++) {
+        if (m_data[i] == c) {
+            return i;
+        }
+    }
+    return m_size;
+}
+
+}  // namespace genome
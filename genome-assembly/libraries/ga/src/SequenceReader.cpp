@@ -0,0 +1,65 @@
+#include "ga/SequenceReader.hpp"
+
+namespace genome {
+
+SequenceReader::SequenceReader(std::istream& input) : m_input(input) {
+    m_input >> std::ws;
+    const int first = m_input.peek();
+    if (first == '>') {
+        m_format = Format::fasta;
+    } else if (first == '@') {
+        m_format = Format::fastq;
+    }
+}
+
+bool SequenceReader::next(std::string& sequence) {
+    sequence.clear();
+    switch (m_format) {
+        case Format::plain:
+            while (read_line(sequence)) {
+                if (!sequence.empty()) {
+                    return true;
+                }
+            }
+            return false;
+        case Format::fastq:
+            // header, sequence, '+' separator, quality
+            while (read_line(m_line)) {
+                if (m_line.empty()) {
+                    continue;
+                }
+                const bool complete = read_line(sequence) && read_line(m_line) && read_line(m_line);
+                return complete || !sequence.empty();
+            }
+            return false;
+        case Format::fasta: {
+            // the header of the next record ends the current one
+            bool found = false;
+            while (read_line(m_line)) {
+                if (!m_line.empty() && m_line.front() == '>') {
+                    if (found) {
+                        return true;
+                    }
+                    found = true;
+                } else {
+                    sequence += m_line;
+                    found = true;
+                }
+            }
+            return found;
+        }
+    }
+    return false;
+}
+
+bool SequenceReader::read_line(std::string& line) {
+    if (!std::getline(m_input, line)) {
+        return false;
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
+
+}  // namespace genome
@@ -0,0 +1,84 @@
+#include "ga/Simulator.hpp"
+
+#include <random>
+#include <stdexcept>
+
+#include "ga/Kmer.hpp"
+
+namespace genome {
+
+std::string random_genome(size_t length, uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    std::string genome(length, 'A');
+    for (char& base : genome) {
+        base = decode_base(gen());
+    }
+    return genome;
+}
+
+std::string repeat_genome(size_t length, size_t repeat_length, size_t units, uint64_t seed) {
+    if (units == 0 || repeat_length == 0) {
+        throw std::invalid_argument("genome::repeat_genome: needs at least one repeat of at least one base");
+    }
+    std::mt19937_64 gen(seed);
+    std::vector<std::string> repeats;
+    for (size_t i = 0; i < units; i++) {
+        repeats.push_back(random_genome(repeat_length, gen()));
+    }
+    std::string genome;
+    genome.reserve(length + repeat_length);
+    while (genome.size() < length) {
+        genome += gen() % 2 == 0 ? repeats[gen() % units] : random_genome(repeat_length, gen());
+    }
+    genome.resize(length);
+    return genome;
+}
+
+std::string reverse_complement(std::string_view sequence) {
+    std::string result(sequence.rbegin(), sequence.rend());
+    for (char& base : result) {
+        const int code = encode_base(base);
+        if (code >= 0) {
+            base = decode_base(3 - static_cast<uint64_t>(code));
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> sample_reads(const std::string& genome, const ReadSimulation& simulation) {
+    std::vector<std::string> reads;
+    if (genome.size() < simulation.length || simulation.length == 0) {
+        return reads;
+    }
+    std::mt19937_64 gen(simulation.seed);
+    std::bernoulli_distribution error(simulation.error_rate);
+    std::bernoulli_distribution reverse(0.5);
+    reads.resize(static_cast<size_t>(static_cast<double>(genome.size()) * simulation.coverage) / simulation.length);
+    for (std::string& read : reads) {
+        read = genome.substr(gen() % (genome.size() - simulation.length + 1), simulation.length);
+        if (simulation.error_rate > 0) {
+            for (char& base : read) {
+                if (error(gen)) {
+                    base = decode_base(static_cast<uint64_t>(encode_base(base)) + 1 + gen() % 3);
+                }
+            }
+        }
+        if (simulation.both_strands && reverse(gen)) {
+            read = reverse_complement(read);
+        }
+    }
+    return reads;
+}
+
+std::vector<std::string> tile_reads(const std::string& genome, size_t length, size_t k) {
+    std::vector<std::string> reads;
+    if (length <= k) {
+        return reads;
+    }
+    for (size_t first = 0; first + k < genome.size(); first += length - k) {
+        reads.push_back(genome.substr(first, length));
+    }
+    return reads;
+}
+
+}  // namespace genome
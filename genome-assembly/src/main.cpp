@@ -1,10 +1,32 @@
+#include <cstdlib>
+#include <exception>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "ga/Genome.hpp"
+#include "ga/MappedReader.hpp"
+
+// usage: ga [k reads.fasta|reads.fastq [contigs]]
+int main(int argc, char* argv[]) {
+    if (argc == 3 || (argc == 4 && std::string(argv[3]) == "contigs")) {
+        try {
+            genome::MappedReader input(argv[2]);
+            const size_t k = std::strtoull(argv[1], nullptr, 10);
+            if (argc == 4) {
+                for (const std::string& contig : genome::contigs(k, input)) {
+                    std::cout << contig << '\n';
+                }
+            } else {
+                std::cout << genome::assembly(k, input) << std::endl;
+            }
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
-int main() {
     const std::vector<std::string> reads = {"AATCT", "ACGAA", "GCTAC"};
     const std::size_t k                  = 2;
     std::cout << "K=" << k << ", [";
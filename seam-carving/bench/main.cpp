@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Energy.hpp"
+#include "Image.hpp"
+#include "SeamCarver.hpp"
+#include "SeamFinder.hpp"
+
+namespace {
+
+template <class F>
+double Measure(F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Image RandomImage(size_t width, size_t height, unsigned seed) {
+    std::mt19937 gen(seed);
+    Image image(width, height);
+    for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+        const auto plane = image.GetPlane(static_cast<Image::Channel>(channel));
+        for (size_t rowId = 0; rowId < height; ++rowId) {
+            for (size_t columnId = 0; columnId < width; ++columnId) {
+                plane(columnId, rowId) = static_cast<uint8_t>(gen());
+            }
+        }
+    }
+    return image;
+}
+
+// connected seam of the given length over positions [0, size): each step moves at most one position
+std::vector<size_t> RandomSeam(size_t length, size_t size, std::mt19937& gen) {
+    std::vector<size_t> seam(length);
+    size_t position = gen() % size;
+    for (size_t& step : seam) {
+        const size_t move = gen() % 3;
+        if (move == 0 && position > 0) {
+            --position;
+        } else if (move == 2 && position + 1 < size) {
+            ++position;
+        }
+        step = position;
+    }
+    return seam;
+}
+
+// pixel reads in the order main.cpp writes them, column by column, against the former layout:
+// a separate vector of 3 ints per pixel for every column
+void BenchLayout(size_t width, size_t height) {
+    const Image image = RandomImage(width, height, 1);
+    std::vector<std::vector<Image::Pixel>> table(width);
+    for (size_t columnId = 0; columnId < width; ++columnId) {
+        for (size_t rowId = 0; rowId < height; ++rowId) {
+            table[columnId].push_back(image.GetPixel(columnId, rowId));
+        }
+    }
+
+    long long sum = 0;
+    const double columnMajor = Measure([&] {
+        for (size_t columnId = 0; columnId < width; ++columnId) {
+            for (size_t rowId = 0; rowId < height; ++rowId) {
+                const Image::Pixel& pixel = table[columnId][rowId];
+                sum += pixel.m_red + pixel.m_green + pixel.m_blue;
+            }
+        }
+    });
+    const double byColumn = Measure([&] {
+        for (size_t columnId = 0; columnId < width; ++columnId) {
+            for (size_t rowId = 0; rowId < height; ++rowId) {
+                const Image::Pixel pixel = image.GetPixel(columnId, rowId);
+                sum += pixel.m_red + pixel.m_green + pixel.m_blue;
+            }
+        }
+    });
+    const double byRow = Measure([&] {
+        for (size_t rowId = 0; rowId < height; ++rowId) {
+            for (size_t columnId = 0; columnId < width; ++columnId) {
+                const Image::Pixel pixel = image.GetPixel(columnId, rowId);
+                sum += pixel.m_red + pixel.m_green + pixel.m_blue;
+            }
+        }
+    });
+    std::cout << width << "x" << height << " pixel reads (checksum " << sum << ")" << std::endl;
+    std::cout << "  column vectors of int pixels: " << columnMajor << " ms, "
+              << width * (height * sizeof(Image::Pixel) + sizeof(std::vector<Image::Pixel>)) / 1000000 << " MB"
+              << std::endl;
+    std::cout << "  planes, by column: " << byColumn << " ms, by row: " << byRow << " ms, "
+              << image.m_data.size() / 1000000 << " MB" << std::endl;
+}
+
+// seam removal keeping the energy map up to date, against recomputing the whole map after each removal
+void BenchRemoval(size_t width, size_t height, size_t seams) {
+    std::mt19937 gen(2);
+    SeamCarver carver(RandomImage(width, height, 3));
+    const double vertical = Measure([&] {
+        for (size_t i = 0; i < seams; ++i) {
+            carver.RemoveVerticalSeam(RandomSeam(carver.GetImageHeight(), carver.GetImageWidth(), gen));
+        }
+    });
+    const double horizontal = Measure([&] {
+        for (size_t i = 0; i < seams; ++i) {
+            carver.RemoveHorizontalSeam(RandomSeam(carver.GetImageWidth(), carver.GetImageHeight(), gen));
+        }
+    });
+    std::vector<float> energy(width * height);
+    const double recompute = Measure([&] {
+        for (size_t i = 0; i < seams; ++i) {
+            ComputeEnergy(carver.GetImage(), energy.data(), carver.GetImageWidth(), 0, carver.GetImageHeight());
+        }
+    });
+    std::cout << width << "x" << height << " seam removal with energy update" << std::endl;
+    std::cout << "  vertical: " << vertical / seams << " ms per seam, horizontal: " << horizontal / seams
+              << " ms per seam" << std::endl;
+    std::cout << "  whole energy map: " << recompute / seams << " ms" << std::endl;
+}
+
+// the energy map from one GetPixelEnergy call per pixel and from the whole-image kernels
+void BenchEnergy(size_t width, size_t height) {
+    const SeamCarver carver(RandomImage(width, height, 4));
+    std::vector<float> energy(width * height);
+    const double perPixel = Measure([&] {
+        for (size_t rowId = 0; rowId < height; ++rowId) {
+            for (size_t columnId = 0; columnId < width; ++columnId) {
+                energy[rowId * width + columnId] = static_cast<float>(carver.GetPixelEnergy(columnId, rowId));
+            }
+        }
+    });
+    std::cout << width << "x" << height << " energy map" << std::endl;
+    std::cout << "  GetPixelEnergy per pixel: " << perPixel << " ms" << std::endl;
+
+    const EnergyKernel detected = DetectEnergyKernel();
+    const char* names[]         = {"scalar", "SSE2", "AVX2"};
+    for (const EnergyKernel kernel : {EnergyKernel::kScalar, EnergyKernel::kSse2, EnergyKernel::kAvx2}) {
+        if (kernel > detected) {
+            break;
+        }
+        const double ms = Measure([&] { ComputeEnergy(carver.GetImage(), energy.data(), width, 0, height, kernel); });
+        std::cout << "  " << names[static_cast<size_t>(kernel)] << " kernel: " << ms << " ms, "
+                  << static_cast<double>(width * height) / ms / 1000 << " Mpixels/s" << std::endl;
+    }
+}
+
+// seam search over the energy map of the image, scalar and with the fastest kernel on a growing number of threads
+void BenchSeams(size_t width, size_t height, size_t maxThreads) {
+    const SeamCarver carver(RandomImage(width, height, 5), 1);
+    const Image::PlaneView<const float> energy = carver.GetEnergyMap();
+    const size_t runs                          = 5;
+    std::cout << width << "x" << height << " seam search, " << runs << " runs" << std::endl;
+    const auto bench = [&](const std::string& name, SeamFinder& finder) {
+        const double vertical = Measure([&] {
+            for (size_t i = 0; i < runs; ++i) {
+                finder.FindVerticalSeam(energy);
+            }
+        });
+        const double horizontal = Measure([&] {
+            for (size_t i = 0; i < runs; ++i) {
+                finder.FindHorizontalSeam(energy);
+            }
+        });
+        std::cout << "  " << name << ": vertical " << vertical / runs << " ms, horizontal " << horizontal / runs
+                  << " ms" << std::endl;
+    };
+    {
+        SeamFinder finder(1, EnergyKernel::kScalar);
+        bench("scalar, 1 thread", finder);
+    }
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        SeamFinder finder(threads);
+        bench(std::to_string(threads) + " threads", finder);
+    }
+}
+
+// sum of the energy left in the image, higher when the removed seams were cheaper
+double TotalEnergy(const SeamCarver& carver) {
+    const Image::PlaneView<const float> energy = carver.GetEnergyMap();
+    double total                               = 0;
+    for (size_t rowId = 0; rowId < energy.m_height; ++rowId) {
+        for (size_t columnId = 0; columnId < energy.m_width; ++columnId) {
+            total += energy(columnId, rowId);
+        }
+    }
+    return total;
+}
+
+// the given number of vertical and horizontal seams removed one by one and in passes of several seams.
+// The image is smooth noise, so that seams have something to avoid
+void BenchBatch(size_t width, size_t height, size_t seams, size_t threads) {
+    Image image = RandomImage(width, height, 6);
+    for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+        const auto plane = image.GetPlane(static_cast<Image::Channel>(channel));
+        for (size_t rowId = 0; rowId < height; ++rowId) {
+            for (size_t columnId = 1; columnId < width; ++columnId) {
+                plane(columnId, rowId) =
+                    static_cast<uint8_t>((plane(columnId - 1, rowId) * 7 + plane(columnId, rowId)) / 8);
+            }
+        }
+    }
+    std::cout << width << "x" << height << " removing " << seams << " vertical and " << seams
+              << " horizontal seams" << std::endl;
+    for (const size_t seamsPerPass : {size_t{1}, size_t{4}, size_t{16}, size_t{64}}) {
+        SeamCarver carver(image, threads);
+        const double vertical   = Measure([&] { carver.RemoveVerticalSeams(seams, seamsPerPass); });
+        const double horizontal = Measure([&] { carver.RemoveHorizontalSeams(seams, seamsPerPass); });
+        std::cout << "  " << seamsPerPass << " per pass: vertical " << vertical << " ms, horizontal " << horizontal
+                  << " ms, energy left " << TotalEnergy(carver) << std::endl;
+    }
+}
+
+}  // namespace
+
+// usage: bench [all|layout|removal|energy|seams|batch] [width] [height] [seams] [max threads]
+// the default size is 4K UHD, 7680 4320 is 8K
+int main(int argc, char* argv[]) {
+    const std::string section = argc > 1 ? argv[1] : "all";
+    const size_t width        = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 3840;
+    const size_t height       = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2160;
+    const size_t seams        = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 100;
+    const size_t threads =
+        argc > 5 ? std::strtoull(argv[5], nullptr, 10) : std::max<size_t>(1, std::thread::hardware_concurrency());
+    const auto enabled        = [&section](const char* name) { return section == "all" || section == name; };
+    if (enabled("layout")) {
+        BenchLayout(width, height);
+    }
+    if (enabled("removal")) {
+        BenchRemoval(width, height, seams);
+    }
+    if (enabled("energy")) {
+        BenchEnergy(width, height);
+    }
+    if (enabled("seams")) {
+        BenchSeams(width, height, threads);
+    }
+    if (enabled("batch")) {
+        BenchBatch(width, height, seams, threads);
+    }
+    return 0;
+}
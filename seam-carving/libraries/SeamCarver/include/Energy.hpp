@@ -0,0 +1,35 @@
+#ifndef ENERGY_HPP
+#define ENERGY_HPP
+
+#include <cstddef>
+
+#include "Image.hpp"
+
+/**
+ * Implementations of the energy kernel, from the slowest
+ */
+enum class EnergyKernel { kScalar, kSse2, kAvx2 };
+
+/**
+ * Returns the fastest kernel the CPU supports
+ */
+EnergyKernel DetectEnergyKernel();
+
+/**
+ * Returns dual-gradient energy of a pixel: sqrt(dx^2 + dy^2), where dx^2 is the sum over channels
+ * of squared differences between the left and right neighbours and dy^2 the same for the ones
+ * above and below. Neighbours wrap around the image borders
+ * @param columnId column index (x)
+ * @param rowId row index (y)
+ */
+double PixelEnergy(const Image& image, size_t columnId, size_t rowId);
+
+/**
+ * Writes energy of every pixel of rows [firstRow, lastRow) to energy[rowId * stride + columnId],
+ * as floats, many pixels per instruction unless the kernel is scalar
+ * @param stride distance between energy rows, at least the image width
+ */
+void ComputeEnergy(const Image& image, float* energy, size_t stride, size_t firstRow, size_t lastRow,
+                   EnergyKernel kernel = DetectEnergyKernel());
+
+#endif  // ENERGY_HPP
@@ -1,9 +1,16 @@
 #ifndef IMAGE_HPP
 #define IMAGE_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
+/**
+ * RGB image stored as three planes of 8-bit channels. Each plane keeps its rows one after another,
+ * m_stride bytes apart, so rows are contiguous and a seam removal only narrows m_width
+ * without moving rows to new places
+ */
 struct Image {
     struct Pixel {
         Pixel(int red, int green, int blue);
@@ -13,11 +20,65 @@ struct Image {
         int m_blue;
     };
 
-    Image(std::vector<std::vector<Pixel>> table);
+    enum Channel : size_t { kRed, kGreen, kBlue, kChannels };
 
-    Pixel GetPixel(size_t columnId, size_t rowId) const;
+    /**
+     * Non-owning view of one plane: m_height rows of m_width values, m_stride values apart
+     */
+    template <class T>
+    struct PlaneView {
+        T* Row(size_t rowId) const {
+            return m_data + rowId * m_stride;
+        }
 
-    std::vector<std::vector<Pixel>> m_table;
+        T& operator()(size_t columnId, size_t rowId) const {
+            return m_data[rowId * m_stride + columnId];
+        }
+
+        T* m_data;
+        size_t m_width;
+        size_t m_height;
+        size_t m_stride;
+    };
+
+    Image() = default;
+
+    /**
+     * Black image, rows are stride values apart (at least width)
+     */
+    Image(size_t width, size_t height, size_t stride = 0);
+
+    /**
+     * Image from a column-major table: table[columnId][rowId]
+     */
+    Image(const std::vector<std::vector<Pixel>>& table);
+
+    PlaneView<uint8_t> GetPlane(Channel channel) {
+        return {m_data.data() + channel * m_planeSize, m_width, m_height, m_stride};
+    }
+
+    PlaneView<const uint8_t> GetPlane(Channel channel) const {
+        return {m_data.data() + channel * m_planeSize, m_width, m_height, m_stride};
+    }
+
+    Pixel GetPixel(size_t columnId, size_t rowId) const {
+        const uint8_t* pixel = m_data.data() + rowId * m_stride + columnId;
+        return Pixel(pixel[kRed * m_planeSize], pixel[kGreen * m_planeSize], pixel[kBlue * m_planeSize]);
+    }
+
+    void SetPixel(size_t columnId, size_t rowId, const Pixel& pixel) {
+        uint8_t* target              = m_data.data() + rowId * m_stride + columnId;
+        target[kRed * m_planeSize]   = static_cast<uint8_t>(pixel.m_red);
+        target[kGreen * m_planeSize] = static_cast<uint8_t>(pixel.m_green);
+        target[kBlue * m_planeSize]  = static_cast<uint8_t>(pixel.m_blue);
+    }
+
+    size_t m_width{0};
+    size_t m_height{0};
+    size_t m_stride{0};
+    // m_stride * the height the image was created with
+    size_t m_planeSize{0};
+    std::vector<uint8_t> m_data;
 };
 
 #endif  // IMAGE_HPP
@@ -1,13 +1,19 @@
 #ifndef SEAMCARVER_HPP
 #define SEAMCARVER_HPP
 
+#include <memory>
+
 #include "Image.hpp"
+#include "SeamFinder.hpp"
 
 class SeamCarver {
     using Seam = std::vector<size_t>;
 
 public:
-    SeamCarver(Image image);
+    /**
+     * @param threads threads finding seams, 0 for one per hardware thread
+     */
+    SeamCarver(Image image, size_t threads = 0);
 
     /**
      * Returns current image
@@ -32,29 +38,61 @@ public:
     double GetPixelEnergy(size_t columnId, size_t rowId) const;
 
     /**
-     * Returns sequence of pixel row indexes (y)
+     * Returns energy of all pixels, kept up to date as seams are removed:
+     * computed once for the whole image and then only for the pixels next to each removed seam
+     */
+    Image::PlaneView<const float> GetEnergyMap() const;
+
+    /**
+     * Returns sequence of pixel row indexes (y) of the seam with the least total energy
      * (x indexes are [0:W-1])
      */
     Seam FindHorizontalSeam() const;
 
     /**
-     * Returns sequence of pixel column indexes (x)
+     * Returns sequence of pixel column indexes (x) of the seam with the least total energy
      * (y indexes are [0:H-1])
      */
     Seam FindVerticalSeam() const;
 
     /**
      * Removes sequence of pixels from the image
+     * (a seam of other length than the image width or with a row index outside the image is ignored)
      */
     void RemoveHorizontalSeam(const Seam& seam);
 
     /**
      * Removes sequence of pixes from the image
+     * (a seam of other length than the image height or with a column index outside the image is ignored)
      */
     void RemoveVerticalSeam(const Seam& seam);
 
+    /**
+     * Removes count horizontal seams, see RemoveVerticalSeams
+     */
+    void RemoveHorizontalSeams(size_t count, size_t seamsPerPass = kSeamsPerPass);
+
+    /**
+     * Removes count vertical seams in passes: one search over the energy map finds up to seamsPerPass
+     * seams sharing no pixel (SeamFinder::FindVerticalSeams), every row is compacted once for all of them
+     * and the energy map is recomputed once. 1 removes the seams of FindVerticalSeam and RemoveVerticalSeam
+     * one by one, larger values take fewer passes over the image for seams that are less exact:
+     * later seams of a pass do not see the energy changed by the earlier ones
+     */
+    void RemoveVerticalSeams(size_t count, size_t seamsPerPass = kSeamsPerPass);
+
+    static constexpr size_t kSeamsPerPass = 16;
+
 private:
+    // compact every row (column) once, skipping the removed pixels, and recompute the energy map
+    void RemoveColumns(const std::vector<Seam>& seams);
+    void RemoveRows(const std::vector<Seam>& seams);
+
     Image m_image;
+    // energy of every pixel, rows m_image.m_stride values apart like the image planes
+    std::vector<float> m_energy;
+    // threads and buffers of the seam search, which does not change the image
+    std::unique_ptr<SeamFinder> m_finder;
 };
 
 #endif  // SEAMCARVER_HPP
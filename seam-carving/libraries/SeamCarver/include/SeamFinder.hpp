@@ -0,0 +1,67 @@
+#ifndef SEAMFINDER_HPP
+#define SEAMFINDER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "Energy.hpp"
+#include "Image.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * Finds minimum-energy seams by dynamic programming over an energy map: the cumulative energy of a pixel
+ * is its own plus the smallest one of the three pixels above it.
+ * Each row depends on the previous one, its columns do not depend on each other, so the columns are split
+ * into one strip per thread and the rows into bands. Within a band a thread also computes the cells of the
+ * neighbour strips it depends on, a margin narrowing by one column per row, so the threads only wait
+ * for each other between bands
+ */
+class SeamFinder {
+public:
+    /**
+     * @param threads threads of the search, 0 for one per hardware thread
+     */
+    explicit SeamFinder(size_t threads = 0, EnergyKernel kernel = DetectEnergyKernel());
+
+    size_t GetThreadCount() const;
+
+    /**
+     * Returns the column index (x) of the seam in every row
+     */
+    std::vector<size_t> FindVerticalSeam(const Image::PlaneView<const float>& energy);
+
+    /**
+     * Returns the row index (y) of the seam in every column: the vertical seam of the transposed map,
+     * so the search reads rows the same way instead of going down columns
+     */
+    std::vector<size_t> FindHorizontalSeam(const Image::PlaneView<const float>& energy);
+
+    /**
+     * Returns up to count vertical seams sharing no pixel, all traced back through the cumulative energy
+     * of one search: from the cheapest ends of the last row up, each step to the cheapest pixel above
+     * not taken by an earlier seam; a seam with no such pixel is dropped. The first one is FindVerticalSeam's.
+     * Fewer seams are returned once the dropped ones took as many steps as 4 * count seams
+     */
+    std::vector<std::vector<size_t>> FindVerticalSeams(const Image::PlaneView<const float>& energy, size_t count);
+
+    /**
+     * The same for horizontal seams, on the transposed map
+     */
+    std::vector<std::vector<size_t>> FindHorizontalSeams(const Image::PlaneView<const float>& energy, size_t count);
+
+private:
+    // fills m_cumulative, m_width values per row
+    void Accumulate(const Image::PlaneView<const float>& energy);
+    std::vector<size_t> Backtrack(size_t width, size_t height) const;
+    std::vector<std::vector<size_t>> BacktrackDisjoint(size_t width, size_t height, size_t count) const;
+    Image::PlaneView<const float> Transpose(const Image::PlaneView<const float>& energy);
+
+    ThreadPool m_pool;
+    EnergyKernel m_kernel;
+    std::vector<float> m_cumulative;
+    std::vector<float> m_transposed;
+    // two rows per thread, each with an infinite value before and after the image columns
+    std::vector<std::vector<float>> m_rows;
+};
+
+#endif  // SEAMFINDER_HPP
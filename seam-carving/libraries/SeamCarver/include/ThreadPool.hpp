@@ -0,0 +1,49 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of threads running one task at a time on all of them: Run(task) calls task(0)
+ * on the calling thread and task(1) ... task(n - 1) on the workers, and returns when all are done
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threads threads taking part in each task including the calling one, 0 for one per hardware thread
+     */
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadCount() const;
+
+    /**
+     * Runs task(threadId) on every thread, an exception thrown by one of them is rethrown here
+     */
+    void Run(const std::function<void(size_t)>& task);
+
+private:
+    void Work(size_t threadId);
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const std::function<void(size_t)>* m_task{nullptr};
+    // incremented by every Run, so a worker sees each task once
+    size_t m_generation{0};
+    size_t m_running{0};
+    std::exception_ptr m_error;
+    bool m_stopping{false};
+};
+
+#endif  // THREADPOOL_HPP
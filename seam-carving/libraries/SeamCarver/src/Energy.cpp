@@ -0,0 +1,180 @@
+#include "Energy.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ENERGY_X86
+#endif
+
+namespace {
+
+// squared gradient of one pixel, the neighbour column and row indexes already wrapped
+int SquaredGradient(const Image& image, size_t left, size_t right, size_t up, size_t down, size_t columnId,
+                    size_t rowId) {
+    int result = 0;
+    for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+        const auto plane = image.GetPlane(static_cast<Image::Channel>(channel));
+        const int dx     = plane(right, rowId) - plane(left, rowId);
+        const int dy     = plane(columnId, down) - plane(columnId, up);
+        result += dx * dx + dy * dy;
+    }
+    return result;
+}
+
+struct Rows {
+    const uint8_t* m_row[Image::kChannels];
+    const uint8_t* m_up[Image::kChannels];
+    const uint8_t* m_down[Image::kChannels];
+};
+
+Rows GetRows(const Image& image, size_t rowId) {
+    const size_t up   = rowId == 0 ? image.m_height - 1 : rowId - 1;
+    const size_t down = rowId + 1 == image.m_height ? 0 : rowId + 1;
+    Rows rows{};
+    for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+        const auto plane     = image.GetPlane(static_cast<Image::Channel>(channel));
+        rows.m_row[channel]  = plane.Row(rowId);
+        rows.m_up[channel]   = plane.Row(up);
+        rows.m_down[channel] = plane.Row(down);
+    }
+    return rows;
+}
+
+// columns [first, last) with neighbours inside the row, returns the first column it did not compute
+using RowKernel = size_t (*)(const Rows& rows, float* energy, size_t first, size_t last);
+
+size_t ScalarRow(const Rows& rows, float* energy, size_t first, size_t last) {
+    for (size_t columnId = first; columnId < last; ++columnId) {
+        int gradient = 0;
+        for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+            const int dx = rows.m_row[channel][columnId + 1] - rows.m_row[channel][columnId - 1];
+            const int dy = rows.m_down[channel][columnId] - rows.m_up[channel][columnId];
+            gradient += dx * dx + dy * dy;
+        }
+        energy[columnId] = std::sqrt(static_cast<float>(gradient));
+    }
+    return last;
+}
+
+#ifdef ENERGY_X86
+
+// 8 pixels per step: differences widened to 16 bits, dx and dy interleaved so that
+// one multiply-add gives dx^2 + dy^2 of each pixel in 32 bits
+size_t Sse2Row(const Rows& rows, float* energy, size_t first, size_t last) {
+    const __m128i zero = _mm_setzero_si128();
+    const auto load   = [&zero](const uint8_t* bytes) {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes)), zero);
+    };
+    size_t columnId = first;
+    for (; columnId + 8 <= last; columnId += 8) {
+        __m128i low  = zero;
+        __m128i high = zero;
+        for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+            const __m128i dx = _mm_sub_epi16(load(rows.m_row[channel] + columnId + 1),
+                                             load(rows.m_row[channel] + columnId - 1));
+            const __m128i dy = _mm_sub_epi16(load(rows.m_down[channel] + columnId),
+                                             load(rows.m_up[channel] + columnId));
+            const __m128i dxyLow  = _mm_unpacklo_epi16(dx, dy);
+            const __m128i dxyHigh = _mm_unpackhi_epi16(dx, dy);
+            low                   = _mm_add_epi32(low, _mm_madd_epi16(dxyLow, dxyLow));
+            high                  = _mm_add_epi32(high, _mm_madd_epi16(dxyHigh, dxyHigh));
+        }
+        _mm_storeu_ps(energy + columnId, _mm_sqrt_ps(_mm_cvtepi32_ps(low)));
+        _mm_storeu_ps(energy + columnId + 4, _mm_sqrt_ps(_mm_cvtepi32_ps(high)));
+    }
+    return columnId;
+}
+
+__attribute__((target("avx2"))) __m256i LoadWidened(const uint8_t* bytes) {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes)));
+}
+
+// the same for 16 pixels, the 256-bit unpacks work within 128-bit lanes,
+// so the halves are put back in pixel order before the store
+__attribute__((target("avx2"))) size_t Avx2Row(const Rows& rows, float* energy, size_t first, size_t last) {
+    size_t columnId = first;
+    for (; columnId + 16 <= last; columnId += 16) {
+        __m256i low  = _mm256_setzero_si256();
+        __m256i high = _mm256_setzero_si256();
+        for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+            const __m256i dx = _mm256_sub_epi16(LoadWidened(rows.m_row[channel] + columnId + 1),
+                                                LoadWidened(rows.m_row[channel] + columnId - 1));
+            const __m256i dy = _mm256_sub_epi16(LoadWidened(rows.m_down[channel] + columnId),
+                                                LoadWidened(rows.m_up[channel] + columnId));
+            const __m256i dxyLow  = _mm256_unpacklo_epi16(dx, dy);
+            const __m256i dxyHigh = _mm256_unpackhi_epi16(dx, dy);
+            low                   = _mm256_add_epi32(low, _mm256_madd_epi16(dxyLow, dxyLow));
+            high                  = _mm256_add_epi32(high, _mm256_madd_epi16(dxyHigh, dxyHigh));
+        }
+        const __m256 lowEnergy  = _mm256_sqrt_ps(_mm256_cvtepi32_ps(low));
+        const __m256 highEnergy = _mm256_sqrt_ps(_mm256_cvtepi32_ps(high));
+        _mm256_storeu_ps(energy + columnId, _mm256_permute2f128_ps(lowEnergy, highEnergy, 0x20));
+        _mm256_storeu_ps(energy + columnId + 8, _mm256_permute2f128_ps(lowEnergy, highEnergy, 0x31));
+    }
+    return columnId;
+}
+
+#endif  // ENERGY_X86
+
+RowKernel GetRowKernel(EnergyKernel kernel) {
+#ifdef ENERGY_X86
+    switch (kernel) {
+        case EnergyKernel::kAvx2:
+            return Avx2Row;
+        case EnergyKernel::kSse2:
+            return Sse2Row;
+        default:
+            return ScalarRow;
+    }
+#else
+    (void)kernel;
+    return ScalarRow;
+#endif
+}
+
+}  // namespace
+
+EnergyKernel DetectEnergyKernel() {
+#ifdef ENERGY_X86
+    static const EnergyKernel kDetected = __builtin_cpu_supports("avx2")   ? EnergyKernel::kAvx2
+                                          : __builtin_cpu_supports("sse2") ? EnergyKernel::kSse2
+                                                                           : EnergyKernel::kScalar;
+    return kDetected;
+#else
+    return EnergyKernel::kScalar;
+#endif
+}
+
+double PixelEnergy(const Image& image, size_t columnId, size_t rowId) {
+    const size_t width  = image.m_width;
+    const size_t height = image.m_height;
+    const size_t left   = columnId == 0 ? width - 1 : columnId - 1;
+    const size_t right  = columnId + 1 == width ? 0 : columnId + 1;
+    const size_t up     = rowId == 0 ? height - 1 : rowId - 1;
+    const size_t down   = rowId + 1 == height ? 0 : rowId + 1;
+    return std::sqrt(static_cast<double>(SquaredGradient(image, left, right, up, down, columnId, rowId)));
+}
+
+void ComputeEnergy(const Image& image, float* energy, size_t stride, size_t firstRow, size_t lastRow,
+                   EnergyKernel kernel) {
+    const size_t width = image.m_width;
+    if (width == 0) {
+        return;
+    }
+    const RowKernel rowKernel = GetRowKernel(kernel);
+    for (size_t rowId = firstRow; rowId < lastRow; ++rowId) {
+        float* energyRow = energy + rowId * stride;
+        // the kernels read both neighbours in the row, the border columns wrap around
+        if (width > 2) {
+            const Rows rows     = GetRows(image, rowId);
+            const size_t vector = rowKernel(rows, energyRow, 1, width - 1);
+            ScalarRow(rows, energyRow, vector, width - 1);
+        }
+        energyRow[0] = static_cast<float>(PixelEnergy(image, 0, rowId));
+        if (width > 1) {
+            energyRow[width - 1] = static_cast<float>(PixelEnergy(image, width - 1, rowId));
+        }
+    }
+}
@@ -1,9 +1,21 @@
 #include "Image.hpp"
 
-Image::Image(std::vector<std::vector<Image::Pixel>> table) : m_table(std::move(table)) {}
+#include <algorithm>
 
-Image::Pixel::Pixel(int red, int green, int blue) : m_red(red), m_green(green), m_blue(blue) {}
+Image::Image(size_t width, size_t height, size_t stride)
+    : m_width(width),
+      m_height(height),
+      m_stride(std::max(width, stride)),
+      m_planeSize(m_stride * height),
+      m_data(kChannels * m_planeSize) {}
 
-Image::Pixel Image::GetPixel(size_t columnId, size_t rowId) const {
-    return m_table[columnId][rowId];
+Image::Image(const std::vector<std::vector<Pixel>>& table)
+    : Image(table.size(), table.empty() ? 0 : table.front().size()) {
+    for (size_t columnId = 0; columnId < m_width; ++columnId) {
+        for (size_t rowId = 0; rowId < m_height; ++rowId) {
+            SetPixel(columnId, rowId, table[columnId][rowId]);
+        }
+    }
 }
+
+Image::Pixel::Pixel(int red, int green, int blue) : m_red(red), m_green(green), m_blue(blue) {}
@@ -1,31 +1,247 @@
 #include "SeamCarver.hpp"
 
-SeamCarver::SeamCarver(Image image) : m_image(std::move(image)) {}
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "Energy.hpp"
+
+namespace {
+
+// the rest of each row moves one value left, rows keep their place and stride
+template <class T>
+void ShiftLeft(const Image::PlaneView<T> &plane, const std::vector<size_t> &seam) {
+    for (size_t rowId = 0; rowId < plane.m_height; ++rowId) {
+        T *row = plane.Row(rowId);
+        std::memmove(row + seam[rowId], row + seam[rowId] + 1, (plane.m_width - seam[rowId] - 1) * sizeof(T));
+    }
+}
+
+// row by row, every column below its seam value takes the value of the row beneath,
+// so the copy runs over contiguous rows instead of down each column. Below the seam whole rows move
+template <class T>
+void ShiftUp(const Image::PlaneView<T> &plane, const std::vector<size_t> &seam) {
+    const auto [first, last] = std::minmax_element(seam.begin(), seam.end());
+    for (size_t rowId = *first; rowId + 1 < plane.m_height; ++rowId) {
+        T *row        = plane.Row(rowId);
+        const T *next = plane.Row(rowId + 1);
+        if (rowId >= *last) {
+            std::memcpy(row, next, plane.m_width * sizeof(T));
+            continue;
+        }
+        for (size_t columnId = 0; columnId < plane.m_width; ++columnId) {
+            row[columnId] = rowId >= seam[columnId] ? next[columnId] : row[columnId];
+        }
+    }
+}
+
+// the positions around which pixels of line i have new neighbours after removing a seam across lines:
+// where the seam crosses line i and its neighbour lines, including the ones wrapped around
+std::pair<size_t, size_t> ChangedRange(const std::vector<size_t> &seam, size_t i) {
+    const size_t previous = seam[i == 0 ? seam.size() - 1 : i - 1];
+    const size_t next     = seam[i + 1 == seam.size() ? 0 : i + 1];
+    return {std::min({previous, seam[i], next}), std::max({previous, seam[i], next})};
+}
+
+}  // namespace
+
+SeamCarver::SeamCarver(Image image, size_t threads)
+    : m_image(std::move(image)), m_finder(std::make_unique<SeamFinder>(threads)) {
+    m_energy.resize(m_image.m_stride * m_image.m_height);
+    ComputeEnergy(m_image, m_energy.data(), m_image.m_stride, 0, m_image.m_height);
+}
 
 const Image &SeamCarver::GetImage() const {
     return m_image;
 }
 
 size_t SeamCarver::GetImageWidth() const {
-    return 0;
+    return m_image.m_width;
 }
 
 size_t SeamCarver::GetImageHeight() const {
-    return 0;
+    return m_image.m_height;
+}
+
+double SeamCarver::GetPixelEnergy(size_t columnId, size_t rowId) const {
+    return PixelEnergy(m_image, columnId, rowId);
 }
 
-double SeamCarver::GetPixelEnergy(size_t, size_t) const {
-    return 0.0;
+Image::PlaneView<const float> SeamCarver::GetEnergyMap() const {
+    return {m_energy.data(), m_image.m_width, m_image.m_height, m_image.m_stride};
 }
 
 SeamCarver::Seam SeamCarver::FindHorizontalSeam() const {
-    return Seam();
+    return m_finder->FindHorizontalSeam(GetEnergyMap());
 }
 
 SeamCarver::Seam SeamCarver::FindVerticalSeam() const {
-    return Seam();
+    return m_finder->FindVerticalSeam(GetEnergyMap());
 }
 
-void SeamCarver::RemoveHorizontalSeam(const Seam &) {}
+void SeamCarver::RemoveHorizontalSeam(const Seam &seam) {
+    const auto outside = [this](size_t rowId) { return rowId >= m_image.m_height; };
+    if (seam.empty() || seam.size() != m_image.m_width || std::any_of(seam.begin(), seam.end(), outside)) {
+        return;
+    }
+    for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+        ShiftUp(m_image.GetPlane(static_cast<Image::Channel>(channel)), seam);
+    }
+    const Image::PlaneView<float> energy{m_energy.data(), m_image.m_width, m_image.m_height, m_image.m_stride};
+    ShiftUp(energy, seam);
+    --m_image.m_height;
 
-void SeamCarver::RemoveVerticalSeam(const Seam &) {}
+    // only pixels next to the seam and on the border rows, which are neighbours across the wrap, get new energy
+    const size_t height = m_image.m_height;
+    if (height == 0) {
+        return;
+    }
+    for (size_t columnId = 0; columnId < m_image.m_width; ++columnId) {
+        const auto [first, last] = ChangedRange(seam, columnId);
+        for (size_t rowId = first == 0 ? 0 : first - 1; rowId <= std::min(last, height - 1); ++rowId) {
+            energy(columnId, rowId) = static_cast<float>(PixelEnergy(m_image, columnId, rowId));
+        }
+        energy(columnId, 0)          = static_cast<float>(PixelEnergy(m_image, columnId, 0));
+        energy(columnId, height - 1) = static_cast<float>(PixelEnergy(m_image, columnId, height - 1));
+    }
+}
+
+void SeamCarver::RemoveVerticalSeam(const Seam &seam) {
+    const auto outside = [this](size_t columnId) { return columnId >= m_image.m_width; };
+    if (seam.empty() || seam.size() != m_image.m_height || std::any_of(seam.begin(), seam.end(), outside)) {
+        return;
+    }
+    for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+        ShiftLeft(m_image.GetPlane(static_cast<Image::Channel>(channel)), seam);
+    }
+    const Image::PlaneView<float> energy{m_energy.data(), m_image.m_width, m_image.m_height, m_image.m_stride};
+    ShiftLeft(energy, seam);
+    --m_image.m_width;
+
+    // only pixels next to the seam and on the border columns, which are neighbours across the wrap, get new energy
+    const size_t width = m_image.m_width;
+    if (width == 0) {
+        return;
+    }
+    for (size_t rowId = 0; rowId < m_image.m_height; ++rowId) {
+        float *row               = energy.Row(rowId);
+        const auto [first, last] = ChangedRange(seam, rowId);
+        for (size_t columnId = first == 0 ? 0 : first - 1; columnId <= std::min(last, width - 1); ++columnId) {
+            row[columnId] = static_cast<float>(PixelEnergy(m_image, columnId, rowId));
+        }
+        row[0]         = static_cast<float>(PixelEnergy(m_image, 0, rowId));
+        row[width - 1] = static_cast<float>(PixelEnergy(m_image, width - 1, rowId));
+    }
+}
+
+void SeamCarver::RemoveHorizontalSeams(size_t count, size_t seamsPerPass) {
+    // an image without pixels has no seams to remove
+    if (m_image.m_width == 0 || m_image.m_height == 0) {
+        return;
+    }
+    count = std::min(count, m_image.m_height);
+    if (seamsPerPass <= 1) {
+        for (; count > 0; --count) {
+            RemoveHorizontalSeam(FindHorizontalSeam());
+        }
+        return;
+    }
+    while (count > 0) {
+        const std::vector<Seam> seams = m_finder->FindHorizontalSeams(GetEnergyMap(), std::min(count, seamsPerPass));
+        if (seams.empty()) {
+            break;
+        }
+        RemoveRows(seams);
+        count -= seams.size();
+    }
+}
+
+void SeamCarver::RemoveVerticalSeams(size_t count, size_t seamsPerPass) {
+    // an image without pixels has no seams to remove
+    if (m_image.m_width == 0 || m_image.m_height == 0) {
+        return;
+    }
+    count = std::min(count, m_image.m_width);
+    if (seamsPerPass <= 1) {
+        for (; count > 0; --count) {
+            RemoveVerticalSeam(FindVerticalSeam());
+        }
+        return;
+    }
+    while (count > 0) {
+        const std::vector<Seam> seams = m_finder->FindVerticalSeams(GetEnergyMap(), std::min(count, seamsPerPass));
+        if (seams.empty()) {
+            break;
+        }
+        RemoveColumns(seams);
+        count -= seams.size();
+    }
+}
+
+void SeamCarver::RemoveColumns(const std::vector<Seam> &seams) {
+    const size_t count  = seams.size();
+    const size_t height = m_image.m_height;
+    // removed columns of every row in increasing order
+    std::vector<size_t> removed(height * count);
+    for (size_t rowId = 0; rowId < height; ++rowId) {
+        for (size_t i = 0; i < count; ++i) {
+            removed[rowId * count + i] = seams[i][rowId];
+        }
+        std::sort(removed.begin() + rowId * count, removed.begin() + (rowId + 1) * count);
+    }
+    // the pieces between removed columns move left by the number of columns removed before them
+    for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+        const auto plane = m_image.GetPlane(static_cast<Image::Channel>(channel));
+        for (size_t rowId = 0; rowId < height; ++rowId) {
+            uint8_t *row          = plane.Row(rowId);
+            const size_t *columns = removed.data() + rowId * count;
+            for (size_t i = 0; i < count; ++i) {
+                const size_t end = i + 1 < count ? columns[i + 1] : plane.m_width;
+                std::memmove(row + columns[i] - i, row + columns[i] + 1, end - columns[i] - 1);
+            }
+        }
+    }
+    m_image.m_width -= count;
+    ComputeEnergy(m_image, m_energy.data(), m_image.m_stride, 0, m_image.m_height);
+}
+
+void SeamCarver::RemoveRows(const std::vector<Seam> &seams) {
+    const size_t count = seams.size();
+    const size_t width = m_image.m_width;
+    // removed rows of every column in increasing order
+    std::vector<size_t> removed(width * count);
+    for (size_t columnId = 0; columnId < width; ++columnId) {
+        for (size_t i = 0; i < count; ++i) {
+            removed[columnId * count + i] = seams[i][columnId];
+        }
+        std::sort(removed.begin() + columnId * count, removed.begin() + (columnId + 1) * count);
+    }
+    // row by row, each column takes the value from as many rows below as it has removed rows up to there.
+    // Rows are only read at or below the one written, so the copy works in place. Above the first removed row
+    // nothing moves, once the last one is passed whole rows move up by count
+    const auto [first, last] = std::minmax_element(removed.begin(), removed.end());
+    std::vector<size_t> skipped(width);
+    for (size_t channel = 0; channel < Image::kChannels; ++channel) {
+        const auto plane = m_image.GetPlane(static_cast<Image::Channel>(channel));
+        std::fill(skipped.begin(), skipped.end(), 0);
+        for (size_t rowId = *first; rowId + count < plane.m_height; ++rowId) {
+            uint8_t *row = plane.Row(rowId);
+            if (rowId + count > *last) {
+                std::memcpy(row, plane.Row(rowId + count), width);
+                continue;
+            }
+            for (size_t columnId = 0; columnId < width; ++columnId) {
+                const size_t *rows = removed.data() + columnId * count;
+                size_t &skip       = skipped[columnId];
+                while (skip < count && rows[skip] <= rowId + skip) {
+                    ++skip;
+                }
+                if (skip > 0) {
+                    row[columnId] = plane(columnId, rowId + skip);
+                }
+            }
+        }
+    }
+    m_image.m_height -= count;
+    ComputeEnergy(m_image, m_energy.data(), m_image.m_stride, 0, m_image.m_height);
+}
@@ -0,0 +1,276 @@
+#include "SeamFinder.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SEAMFINDER_X86
+#endif
+
+namespace {
+
+// cumulative[i] = energy[i] + min(previous[i], previous[i + 1], previous[i + 2]) for i in [0, count),
+// previous starts one column to the left of the others
+using RowKernel = void (*)(const float* previous, const float* energy, float* cumulative, size_t count);
+
+void ScalarRow(const float* previous, const float* energy, float* cumulative, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        cumulative[i] = energy[i] + std::min(std::min(previous[i], previous[i + 1]), previous[i + 2]);
+    }
+}
+
+#ifdef SEAMFINDER_X86
+
+void Sse2Row(const float* previous, const float* energy, float* cumulative, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 smallest = _mm_min_ps(_mm_min_ps(_mm_loadu_ps(previous + i), _mm_loadu_ps(previous + i + 1)),
+                                           _mm_loadu_ps(previous + i + 2));
+        _mm_storeu_ps(cumulative + i, _mm_add_ps(_mm_loadu_ps(energy + i), smallest));
+    }
+    ScalarRow(previous + i, energy + i, cumulative + i, count - i);
+}
+
+__attribute__((target("avx2"))) void Avx2Row(const float* previous, const float* energy, float* cumulative,
+                                             size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 smallest = _mm256_min_ps(
+            _mm256_min_ps(_mm256_loadu_ps(previous + i), _mm256_loadu_ps(previous + i + 1)),
+            _mm256_loadu_ps(previous + i + 2));
+        _mm256_storeu_ps(cumulative + i, _mm256_add_ps(_mm256_loadu_ps(energy + i), smallest));
+    }
+    ScalarRow(previous + i, energy + i, cumulative + i, count - i);
+}
+
+#endif  // SEAMFINDER_X86
+
+RowKernel GetRowKernel(EnergyKernel kernel) {
+#ifdef SEAMFINDER_X86
+    switch (kernel) {
+        case EnergyKernel::kAvx2:
+            return Avx2Row;
+        case EnergyKernel::kSse2:
+            return Sse2Row;
+        default:
+            return ScalarRow;
+    }
+#else
+    (void)kernel;
+    return ScalarRow;
+#endif
+}
+
+// the margin costs about bandRows extra cells per row and thread, 1/16 of a strip,
+// while each band boundary is one wait for all threads
+size_t GetBandRows(size_t stripWidth) {
+    return std::clamp<size_t>(stripWidth / 16, 8, 1024);
+}
+
+constexpr size_t kTransposeBlock = 16;
+
+}  // namespace
+
+SeamFinder::SeamFinder(size_t threads, EnergyKernel kernel)
+    : m_pool(threads), m_kernel(kernel), m_rows(2 * m_pool.GetThreadCount()) {}
+
+size_t SeamFinder::GetThreadCount() const {
+    return m_pool.GetThreadCount();
+}
+
+std::vector<size_t> SeamFinder::FindVerticalSeam(const Image::PlaneView<const float>& energy) {
+    if (energy.m_width == 0 || energy.m_height == 0) {
+        return {};
+    }
+    Accumulate(energy);
+    return Backtrack(energy.m_width, energy.m_height);
+}
+
+std::vector<size_t> SeamFinder::FindHorizontalSeam(const Image::PlaneView<const float>& energy) {
+    if (energy.m_width == 0 || energy.m_height == 0) {
+        return {};
+    }
+    return FindVerticalSeam(Transpose(energy));
+}
+
+std::vector<std::vector<size_t>> SeamFinder::FindVerticalSeams(const Image::PlaneView<const float>& energy,
+                                                               size_t count) {
+    if (energy.m_width == 0 || energy.m_height == 0 || count == 0) {
+        return {};
+    }
+    Accumulate(energy);
+    return BacktrackDisjoint(energy.m_width, energy.m_height, count);
+}
+
+std::vector<std::vector<size_t>> SeamFinder::FindHorizontalSeams(const Image::PlaneView<const float>& energy,
+                                                                 size_t count) {
+    if (energy.m_width == 0 || energy.m_height == 0 || count == 0) {
+        return {};
+    }
+    return FindVerticalSeams(Transpose(energy), count);
+}
+
+void SeamFinder::Accumulate(const Image::PlaneView<const float>& energy) {
+    const size_t width  = energy.m_width;
+    const size_t height = energy.m_height;
+    m_cumulative.resize(width * height);
+    for (std::vector<float>& row : m_rows) {
+        row.assign(width + 2, std::numeric_limits<float>::infinity());
+    }
+
+    const size_t threads   = std::min(m_pool.GetThreadCount(), width);
+    const size_t strip     = (width + threads - 1) / threads;
+    const size_t bandRows  = threads == 1 ? height : GetBandRows(strip);
+    const RowKernel kernel = GetRowKernel(m_kernel);
+
+    for (size_t firstRow = 0; firstRow < height; firstRow += bandRows) {
+        const size_t lastRow = std::min(height, firstRow + bandRows);
+        m_pool.Run([&](size_t threadId) {
+            const size_t begin = threadId * strip;
+            const size_t end   = std::min(width, begin + strip);
+            if (begin >= end) {
+                return;
+            }
+            // columns [low(rowId), high(rowId)) of a row are computed, enough for the strip at the band's last row
+            const auto low  = [&](size_t rowId) { return begin - std::min(begin, lastRow - 1 - rowId); };
+            const auto high = [&](size_t rowId) { return std::min(width, end + lastRow - 1 - rowId); };
+            // index -1 and width hold infinity
+            float* previous = m_rows[2 * threadId].data() + 1;
+            float* current  = m_rows[2 * threadId + 1].data() + 1;
+
+            // the row above the band, zero above the first row
+            const size_t copyBegin = low(firstRow) == 0 ? 0 : low(firstRow) - 1;
+            const size_t copyEnd   = std::min(width, high(firstRow) + 1);
+            if (firstRow == 0) {
+                std::fill(previous + copyBegin, previous + copyEnd, 0.0f);
+            } else {
+                const float* above = m_cumulative.data() + (firstRow - 1) * width;
+                std::copy(above + copyBegin, above + copyEnd, previous + copyBegin);
+            }
+
+            for (size_t rowId = firstRow; rowId < lastRow; ++rowId) {
+                const size_t from = low(rowId);
+                kernel(previous + from - 1, energy.Row(rowId) + from, current + from, high(rowId) - from);
+                std::copy(current + begin, current + end, m_cumulative.data() + rowId * width + begin);
+                std::swap(previous, current);
+            }
+        });
+    }
+}
+
+std::vector<size_t> SeamFinder::Backtrack(size_t width, size_t height) const {
+    std::vector<size_t> seam(height);
+    const float* row = m_cumulative.data() + (height - 1) * width;
+    seam[height - 1] = static_cast<size_t>(std::min_element(row, row + width) - row);
+    for (size_t rowId = height - 1; rowId > 0; --rowId) {
+        const float* above  = m_cumulative.data() + (rowId - 1) * width;
+        const size_t column = seam[rowId];
+        size_t best         = column;
+        if (column > 0 && above[column - 1] < above[best]) {
+            best = column - 1;
+        }
+        if (column + 1 < width && above[column + 1] < above[best]) {
+            best = column + 1;
+        }
+        seam[rowId - 1] = best;
+    }
+    return seam;
+}
+
+std::vector<std::vector<size_t>> SeamFinder::BacktrackDisjoint(size_t width, size_t height, size_t count) const {
+    const float* lastRow = m_cumulative.data() + (height - 1) * width;
+    std::vector<size_t> ends(width);
+    for (size_t columnId = 0; columnId < width; ++columnId) {
+        ends[columnId] = columnId;
+    }
+    std::stable_sort(ends.begin(), ends.end(), [lastRow](size_t a, size_t b) { return lastRow[a] < lastRow[b]; });
+
+    std::vector<uint8_t> taken(width * height);
+    std::vector<std::vector<size_t>> seams;
+    std::vector<size_t> seam(height);
+    // seams traced from neighbouring ends often run into each other. The steps of dropped ones are limited
+    // to the steps of 4 * count seams, after which the seams found so far are returned
+    size_t wastedSteps = 0;
+    for (size_t i = 0; i < width && seams.size() < count && wastedSteps < 4 * count * height; ++i) {
+        if (taken[(height - 1) * width + ends[i]]) {
+            continue;
+        }
+        seam[height - 1] = ends[i];
+        size_t rowId     = height - 1;
+        for (; rowId > 0; --rowId) {
+            const float* above  = m_cumulative.data() + (rowId - 1) * width;
+            const uint8_t* used = taken.data() + (rowId - 1) * width;
+            const size_t column = seam[rowId];
+            size_t best         = width;
+            // the same order as Backtrack, so an untaken path is followed the same way
+            for (const size_t candidate : {column, column - 1, column + 1}) {
+                if (candidate < width && !used[candidate] && (best == width || above[candidate] < above[best])) {
+                    best = candidate;
+                }
+            }
+            if (best == width) {
+                break;
+            }
+            seam[rowId - 1] = best;
+        }
+        if (rowId > 0) {
+            wastedSteps += height - rowId;
+            continue;
+        }
+        for (size_t y = 0; y < height; ++y) {
+            taken[y * width + seam[y]] = 1;
+        }
+        seams.push_back(seam);
+    }
+    return seams;
+}
+
+Image::PlaneView<const float> SeamFinder::Transpose(const Image::PlaneView<const float>& energy) {
+    const size_t width  = energy.m_width;
+    const size_t height = energy.m_height;
+    m_transposed.resize(width * height);
+    float* transposed = m_transposed.data();
+    // blocks of the map keep both the rows read and the rows written in cache,
+    // each thread writes the rows of its own blocks of columns
+    const size_t blocks  = (width + kTransposeBlock - 1) / kTransposeBlock;
+    const size_t threads = m_pool.GetThreadCount();
+    m_pool.Run([&](size_t threadId) {
+        for (size_t block = threadId * blocks / threads; block < (threadId + 1) * blocks / threads; ++block) {
+            const size_t firstColumn = block * kTransposeBlock;
+            const size_t lastColumn  = std::min(width, firstColumn + kTransposeBlock);
+            for (size_t firstRow = 0; firstRow < height; firstRow += kTransposeBlock) {
+                const size_t lastRow = std::min(height, firstRow + kTransposeBlock);
+                size_t rowId         = firstRow;
+#ifdef SEAMFINDER_X86
+                // 4x4 tiles go through registers, the block's edges one value at a time
+                for (; rowId + 4 <= lastRow; rowId += 4) {
+                    size_t columnId = firstColumn;
+                    for (; columnId + 4 <= lastColumn; columnId += 4) {
+                        __m128 row0 = _mm_loadu_ps(energy.Row(rowId) + columnId);
+                        __m128 row1 = _mm_loadu_ps(energy.Row(rowId + 1) + columnId);
+                        __m128 row2 = _mm_loadu_ps(energy.Row(rowId + 2) + columnId);
+                        __m128 row3 = _mm_loadu_ps(energy.Row(rowId + 3) + columnId);
+                        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+                        _mm_storeu_ps(transposed + columnId * height + rowId, row0);
+                        _mm_storeu_ps(transposed + (columnId + 1) * height + rowId, row1);
+                        _mm_storeu_ps(transposed + (columnId + 2) * height + rowId, row2);
+                        _mm_storeu_ps(transposed + (columnId + 3) * height + rowId, row3);
+                    }
+                    for (; columnId < lastColumn; ++columnId) {
+                        for (size_t i = rowId; i < rowId + 4; ++i) {
+                            transposed[columnId * height + i] = energy(columnId, i);
+                        }
+                    }
+                }
+#endif
+                for (; rowId < lastRow; ++rowId) {
+                    for (size_t columnId = firstColumn; columnId < lastColumn; ++columnId) {
+                        transposed[columnId * height + rowId] = energy(columnId, rowId);
+                    }
+                }
+            }
+        }
+    });
+    return {transposed, height, width, height};
+}
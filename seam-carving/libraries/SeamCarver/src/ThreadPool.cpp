@@ -0,0 +1,94 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+    // hardware_concurrency() may report 0
+    const size_t count = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    m_workers.reserve(count - 1);
+    for (size_t threadId = 1; threadId < count; ++threadId) {
+        m_workers.emplace_back([this, threadId] { Work(threadId); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_start.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::GetThreadCount() const {
+    return m_workers.size() + 1;
+}
+
+void ThreadPool::Run(const std::function<void(size_t)>& task) {
+    if (m_workers.empty()) {
+        task(0);
+        return;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_task    = &task;
+        m_running = m_workers.size();
+        m_error   = nullptr;
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    std::exception_ptr error;
+    try {
+        task(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::unique_lock lock(m_mutex);
+    m_done.wait(lock, [this] { return m_running == 0; });
+    m_task = nullptr;
+    if (!error) {
+        error = m_error;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::Work(size_t threadId) {
+    size_t seen = 0;
+    for (;;) {
+        const std::function<void(size_t)>* task = nullptr;
+        {
+            std::unique_lock lock(m_mutex);
+            m_start.wait(lock, [this, seen] { return m_stopping || m_generation != seen; });
+            if (m_stopping) {
+                return;
+            }
+            seen = m_generation;
+            task = m_task;
+        }
+
+        std::exception_ptr error;
+        try {
+            (*task)(threadId);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        bool last = false;
+        {
+            std::lock_guard lock(m_mutex);
+            if (error && !m_error) {
+                m_error = error;
+            }
+            last = --m_running == 0;
+        }
+        if (last) {
+            m_done.notify_one();
+        }
+    }
+}
@@ -4,20 +4,18 @@
 #include "Image.hpp"
 #include "SeamCarver.hpp"
 
-static std::vector<std::vector<Image::Pixel>> ReadImageFromCSV(std::ifstream& input) {
+static Image ReadImageFromCSV(std::ifstream& input) {
     size_t width, height;
     input >> width >> height;
-    std::vector<std::vector<Image::Pixel>> table;
+    Image image(width, height);
     for (size_t columnId = 0; columnId < width; ++columnId) {
-        std::vector<Image::Pixel> column;
         for (size_t rowId = 0; rowId < height; ++rowId) {
-            size_t red, green, blue;
+            int red, green, blue;
             input >> red >> green >> blue;
-            column.emplace_back(red, green, blue);
+            image.SetPixel(columnId, rowId, Image::Pixel(red, green, blue));
         }
-        table.emplace_back(std::move(column));
     }
-    return table;
+    return image;
 }
 
 static void WriteImageToCSV(const SeamCarver& carver, std::ofstream& output) {
@@ -50,11 +48,8 @@ int main(int argc, char* argv[]) {
         SeamCarver carver(std::move(imageSource));
         std::cout << "Image: " << carver.GetImageWidth() << "x" << carver.GetImageHeight() << std::endl;
         const size_t pixelsToDelete = 150;
-        for (size_t i = 0; i < pixelsToDelete; ++i) {
-            std::vector<size_t> seam = carver.FindVerticalSeam();
-            carver.RemoveVerticalSeam(seam);
-            std::cout << "width = " << carver.GetImageWidth() << ", height = " << carver.GetImageHeight() << std::endl;
-        }
+        carver.RemoveVerticalSeams(pixelsToDelete);
+        std::cout << "width = " << carver.GetImageWidth() << ", height = " << carver.GetImageHeight() << std::endl;
         std::ofstream outputFile(argv[2]);
         WriteImageToCSV(carver, outputFile);
         std::cout << "Updated image is written to " << argv[2] << "." << std::endl;
@@ -0,0 +1,459 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tree/ConcurrentTree.hpp"
+#include "tree/Tree.hpp"
+
+namespace {
+
+template <class F>
+double measure(F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const std::string& name, double ms) {
+    std::cout << name << ": " << ms << " ms" << std::endl;
+}
+
+void benchBuild(size_t n) {
+    std::vector<int> ids(n);
+    std::iota(ids.begin(), ids.end(), 0);
+
+    {
+        AVL tree;
+        report("insert " + std::to_string(n) + " sorted ids", measure([&] {
+                   for (int id : ids) {
+                       tree.insert(id);
+                   }
+               }));
+    }
+    {
+        AVL tree;
+        report("build " + std::to_string(n) + " sorted ids", measure([&] { tree.build(ids); }));
+    }
+
+    std::vector<int> extra(n / 4);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(2 * n));
+    for (int& value : extra) {
+        value = dist(gen);
+    }
+    {
+        AVL tree;
+        tree.build(ids);
+        report("insert " + std::to_string(extra.size()) + " random ids one by one", measure([&] {
+                   for (int value : extra) {
+                       tree.insert(value);
+                   }
+               }));
+    }
+    {
+        AVL tree;
+        tree.build(ids);
+        report("insert_range " + std::to_string(extra.size()) + " random ids", measure([&] { tree.insert_range(extra); }));
+    }
+}
+
+std::vector<int> randomValues(size_t n, unsigned seed) {
+    std::vector<int> values(n);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(4 * n));
+    for (int& value : values) {
+        value = dist(gen);
+    }
+    return values;
+}
+
+void benchOperations(size_t n) {
+    const std::vector<int> keys    = randomValues(n, 1);
+    const std::vector<int> queries = randomValues(n, 2);
+    AVL tree;
+    report("insert " + std::to_string(n) + " random keys", measure([&] {
+               for (int key : keys) {
+                   tree.insert(key);
+               }
+           }));
+    size_t found = 0;
+    report("contains " + std::to_string(n) + " random keys", measure([&] {
+               for (int key : queries) {
+                   found += tree.contains(key);
+               }
+           }));
+    report("remove " + std::to_string(n) + " random keys", measure([&] {
+               for (int key : queries) {
+                   tree.remove(key);
+               }
+           }));
+    std::cout << "(found " << found << ", left " << tree.size() << ")" << std::endl;
+}
+
+void benchMixed(size_t n) {
+    // lookups, inserts and removes 2:1:1 over a key space twice the tree size,
+    // so a good share of the updates hit a present key on insert or an absent one on remove
+    std::mt19937 gen(4);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(2 * n - 1));
+    std::vector<int> keys(n);
+    for (int& key : keys) {
+        key = dist(gen);
+    }
+    std::vector<std::pair<int, int>> operations(2 * n);
+    for (auto& [kind, key] : operations) {
+        kind = static_cast<int>(gen() % 4);
+        key  = dist(gen);
+    }
+
+    AVL tree;
+    tree.build(keys);
+    size_t changed = 0;
+    report("mixed " + std::to_string(operations.size()) + " contains/insert/remove", measure([&] {
+               for (const auto& [kind, key] : operations) {
+                   if (kind == 2) {
+                       changed += tree.insert(key);
+                   } else if (kind == 3) {
+                       changed += tree.remove(key);
+                   } else {
+                       changed += tree.contains(key);
+                   }
+               }
+           }));
+    std::cout << "(hits " << changed << ", left " << tree.size() << ")" << std::endl;
+}
+
+void benchReaders(size_t n, size_t maxReaders) {
+    ConcurrentAVL tree;
+    tree.build(randomValues(n, 1));
+    const std::vector<int> queries = randomValues(1 << 20, 2);
+    const std::vector<int> updates = randomValues(1 << 20, 3);
+
+    for (size_t readers = 1; readers <= maxReaders; readers *= 2) {
+        std::atomic<bool> stop{false};
+        std::atomic<size_t> lookups{0};
+        std::atomic<size_t> hits{0};
+        std::vector<std::thread> threads;
+        for (size_t r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r] {
+                size_t done  = 0;
+                size_t found = 0;
+                size_t i     = r * 7919;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    found += tree.contains(queries[i++ & (queries.size() - 1)]);
+                    ++done;
+                }
+                lookups += done;
+                hits += found;
+            });
+        }
+        std::thread writer([&] {
+            size_t i = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const int value = updates[i++ & (updates.size() - 1)];
+                if (i % 2 == 0) {
+                    tree.insert(value);
+                } else {
+                    tree.remove(value);
+                }
+            }
+        });
+        const double ms = measure([&] { std::this_thread::sleep_for(std::chrono::seconds(1)); });
+        stop = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        writer.join();
+        std::cout << readers << " readers + 1 writer: " << static_cast<double>(lookups) / ms * 1000 << " lookups/s"
+                  << " (hits " << hits << ")" << std::endl;
+    }
+}
+
+void benchQueries(size_t n) {
+    AVL tree;
+    tree.build(randomValues(n, 1));
+    const std::vector<int> queries = randomValues(1000, 2);
+    const int width                = 400;
+    size_t checksum                = 0;
+
+    const auto reportQuery = [&queries](const std::string& name, double ms) {
+        std::cout << name << ": " << ms * 1000 / static_cast<double>(queries.size()) << " us/query" << std::endl;
+    };
+
+    reportQuery("values() + lower_bound rank", measure([&] {
+                    for (int q : queries) {
+                        const std::vector<int> values = tree.values();
+                        checksum += std::lower_bound(values.begin(), values.end(), q) - values.begin();
+                    }
+                }));
+    reportQuery("rank", measure([&] {
+                    for (int q : queries) {
+                        checksum += tree.rank(q);
+                    }
+                }));
+    reportQuery("values() + index select", measure([&] {
+                    for (int q : queries) {
+                        const std::vector<int> values = tree.values();
+                        checksum += values[static_cast<size_t>(q) % values.size()];
+                    }
+                }));
+    reportQuery("select", measure([&] {
+                    for (int q : queries) {
+                        checksum += tree.select(static_cast<size_t>(q) % tree.size());
+                    }
+                }));
+    reportQuery("values() + count in range", measure([&] {
+                    for (int q : queries) {
+                        const std::vector<int> values = tree.values();
+                        checksum += std::upper_bound(values.begin(), values.end(), q + width) -
+                                    std::lower_bound(values.begin(), values.end(), q);
+                    }
+                }));
+    reportQuery("count_in_range", measure([&] {
+                    for (int q : queries) {
+                        checksum += tree.count_in_range(q, q + width);
+                    }
+                }));
+    reportQuery("values() + range scan", measure([&] {
+                    for (int q : queries) {
+                        const std::vector<int> values = tree.values();
+                        for (auto it = std::lower_bound(values.begin(), values.end(), q);
+                             it != values.end() && *it <= q + width; ++it) {
+                            checksum += *it;
+                        }
+                    }
+                }));
+    reportQuery("range scan", measure([&] {
+                    for (int q : queries) {
+                        for (int value : tree.range(q, q + width)) {
+                            checksum += value;
+                        }
+                    }
+                }));
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+}
+
+void benchFrozen(size_t maxSize) {
+    const std::vector<int> queries = randomValues(1 << 20, 2);
+    const int width                = 64;
+    size_t checksum                = 0;
+    for (size_t n = 100000; n <= maxSize; n *= 10) {
+        AVL tree;
+        tree.build(randomValues(n, 1));
+        FrozenAVL frozen;
+        report("freeze " + std::to_string(n) + " keys", measure([&] { frozen = tree.freeze(); }));
+
+        // queries are drawn from a range 4 times wider than the tree, the range scan visits ~16 keys
+        const auto reportQueries = [&queries](const std::string& name, double treeMs, double frozenMs) {
+            const double perQuery = 1e6 / static_cast<double>(queries.size());
+            std::cout << "  " << name << ": " << treeMs * perQuery << " / " << frozenMs * perQuery
+                      << " ns/query (AVL / frozen)" << std::endl;
+        };
+        reportQueries("contains",
+                      measure([&] {
+                          for (int q : queries) {
+                              checksum += tree.contains(q);
+                          }
+                      }),
+                      measure([&] {
+                          for (int q : queries) {
+                              checksum += frozen.contains(q);
+                          }
+                      }));
+        reportQueries("rank",
+                      measure([&] {
+                          for (int q : queries) {
+                              checksum += tree.rank(q);
+                          }
+                      }),
+                      measure([&] {
+                          for (int q : queries) {
+                              checksum += frozen.rank(q);
+                          }
+                      }));
+        reportQueries("range scan",
+                      measure([&] {
+                          for (int q : queries) {
+                              for (int value : tree.range(q, q + width)) {
+                                  checksum += value;
+                              }
+                          }
+                      }),
+                      measure([&] {
+                          for (int q : queries) {
+                              for (int value : frozen.range(q, q + width)) {
+                                  checksum += value;
+                              }
+                          }
+                      }));
+    }
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+}
+
+void benchSetOperations(size_t n, size_t maxThreads) {
+    AVL first;
+    first.build(randomValues(n, 1));
+    AVL second;
+    second.build(randomValues(n, 2));
+    AVL small;
+    small.build(randomValues(n / 1000, 3));
+
+    // each operation works on a fresh copy of the first tree, copying is not measured
+    const auto run = [&first](const std::string& name, auto&& operation) {
+        AVL tree        = first;
+        const double ms = measure([&] { operation(tree); });
+        std::cout << name << ": " << ms << " ms (" << tree.size() << " keys)" << std::endl;
+    };
+    for (const AVL* other : {&second, &small}) {
+        const std::string sizes = " " + std::to_string(n) + " and " + std::to_string(other->size());
+        run("values() + insert union" + sizes, [other](AVL& tree) {
+            for (int value : other->values()) {
+                tree.insert(value);
+            }
+        });
+        run("unite" + sizes, [other](AVL& tree) { tree.unite(*other); });
+        run("values() + contains intersection" + sizes, [other](AVL& tree) {
+            AVL result;
+            for (int value : other->values()) {
+                if (tree.contains(value)) {
+                    result.insert(value);
+                }
+            }
+            tree = std::move(result);
+        });
+        run("intersect" + sizes, [other](AVL& tree) { tree.intersect(*other); });
+        run("values() + remove difference" + sizes, [other](AVL& tree) {
+            for (int value : other->values()) {
+                tree.remove(value);
+            }
+        });
+        run("subtract" + sizes, [other](AVL& tree) { tree.subtract(*other); });
+    }
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads - 1);
+        const std::string suffix = " on " + std::to_string(threads) + " threads";
+        run("unite" + suffix, [&](AVL& tree) { tree.unite(second, &pool); });
+        run("intersect" + suffix, [&](AVL& tree) { tree.intersect(second, &pool); });
+        run("subtract" + suffix, [&](AVL& tree) { tree.subtract(second, &pool); });
+    }
+}
+
+template <class Tree, class Std, class Keys>
+void compareWithStd(const std::string& name, const Keys& keys, const Keys& queries) {
+    Tree tree;
+    Std reference;
+    size_t found = 0;
+    const double treeInsert = measure([&] {
+        for (const auto& key : keys) {
+            if constexpr (std::is_same_v<typename Tree::mapped_type, void>) {
+                tree.insert(key);
+            } else {
+                tree.insert(key, typename Tree::mapped_type{});
+            }
+        }
+    });
+    const double stdInsert = measure([&] {
+        for (const auto& key : keys) {
+            if constexpr (std::is_same_v<typename Tree::mapped_type, void>) {
+                reference.insert(key);
+            } else {
+                reference.emplace(key, typename Tree::mapped_type{});
+            }
+        }
+    });
+    const double treeFind = measure([&] {
+        for (const auto& key : queries) {
+            found += tree.contains(key);
+        }
+    });
+    const double stdFind = measure([&] {
+        for (const auto& key : queries) {
+            found += reference.count(key);
+        }
+    });
+    const double treeRemove = measure([&] {
+        for (const auto& key : queries) {
+            tree.remove(key);
+        }
+    });
+    const double stdRemove = measure([&] {
+        for (const auto& key : queries) {
+            reference.erase(key);
+        }
+    });
+    std::cout << name << ": insert " << treeInsert << " / " << stdInsert << " ms, find " << treeFind << " / "
+              << stdFind << " ms, remove " << treeRemove << " / " << stdRemove << " ms (AVL / std, found " << found
+              << ")" << std::endl;
+}
+
+template <class Key>
+std::vector<Key> convertKeys(const std::vector<int>& values) {
+    std::vector<Key> keys;
+    keys.reserve(values.size());
+    for (int value : values) {
+        if constexpr (std::is_same_v<Key, std::string>) {
+            keys.push_back("id-" + std::to_string(value));
+        } else {
+            keys.push_back(static_cast<Key>(value) * 2654435761LL);
+        }
+    }
+    return keys;
+}
+
+void benchGeneric(size_t n) {
+    const std::vector<int> keys    = randomValues(n, 1);
+    const std::vector<int> queries = randomValues(n, 2);
+    compareWithStd<AVL, std::set<int>>("int set", keys, queries);
+    const auto keys64    = convertKeys<std::int64_t>(keys);
+    const auto queries64 = convertKeys<std::int64_t>(queries);
+    compareWithStd<AVLSet<std::int64_t>, std::set<std::int64_t>>("int64 set", keys64, queries64);
+    compareWithStd<AVLMap<std::int64_t, std::int64_t>, std::map<std::int64_t, std::int64_t>>("int64 map", keys64, queries64);
+    compareWithStd<AVLSet<std::string>, std::set<std::string>>("string set", convertKeys<std::string>(keys),
+                                                               convertKeys<std::string>(queries));
+}
+
+}  // namespace
+
+// usage: bench [all|build|operations|mixed|readers|queries|frozen|setops|generic] [n]
+int main(int argc, char* argv[]) {
+    const std::string section = argc > 1 ? argv[1] : "all";
+    const size_t n            = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+    const auto enabled        = [&section](const char* name) { return section == "all" || section == name; };
+    if (enabled("build")) {
+        benchBuild(n);
+    }
+    if (enabled("operations")) {
+        benchOperations(2 * n);
+    }
+    if (enabled("mixed")) {
+        benchMixed(n);
+    }
+    if (enabled("readers")) {
+        benchReaders(n, 2 * std::max(1u, std::thread::hardware_concurrency()));
+    }
+    if (enabled("queries")) {
+        benchQueries(n);
+    }
+    if (enabled("setops")) {
+        benchSetOperations(n, 32);
+    }
+    if (enabled("frozen")) {
+        benchFrozen(n);
+    }
+    if (enabled("generic")) {
+        benchGeneric(n);
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef CONCURRENT_TREE_HPP
+#define CONCURRENT_TREE_HPP
+
+#include <shared_mutex>
+
+#include "tree/Tree.hpp"
+
+// AVL shared between many reader threads and one writer thread:
+// lookups take a shared lock and never write to the nodes,
+// modifications take an exclusive lock
+class ConcurrentAVL {
+public:
+    [[nodiscard]] bool contains(int value) const;
+    bool insert(int value);
+    bool remove(int value);
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] bool empty() const;
+
+    [[nodiscard]] std::vector<int> values() const;
+
+    void build(std::vector<int> values);
+    void insert_range(std::vector<int> values);
+    void clear();
+
+private:
+    mutable std::shared_mutex mutex;
+    AVL tree;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef FROZEN_TREE_HPP
+#define FROZEN_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// immutable snapshot of an AVL tree (see BasicAVL::freeze) laid out as a static B+ tree:
+// the sorted keys are cut into nodes of 16, and every upper level keeps, for each group
+// of 17 nodes below, the 16 smallest keys of all but the first of them. A lookup reads one
+// contiguous node per level and counts the keys less than the searched one without branching,
+// which compilers turn into a few SIMD compares for arithmetic keys
+template <class Key, class Mapped = void, class Compare = std::less<Key>>
+class BasicFrozenAVL {
+    static constexpr bool isMap = !std::is_void_v<Mapped>;
+
+public:
+    using key_type    = Key;
+    using mapped_type = Mapped;
+    using value_type  = std::conditional_t<isMap, std::pair<Key, Mapped>, Key>;
+
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    struct Range {
+        const_iterator first;
+        const_iterator last;
+
+        [[nodiscard]] const_iterator begin() const { return first; }
+        [[nodiscard]] const_iterator end() const { return last; }
+    };
+
+    explicit BasicFrozenAVL(const Compare& comp = Compare());
+
+    [[nodiscard]] bool contains(const Key& key) const noexcept;
+    [[nodiscard]] const_iterator find(const Key& key) const;
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+
+    [[nodiscard]] const_iterator begin() const;
+    [[nodiscard]] const_iterator end() const;
+
+    // same contracts as in BasicAVL
+    [[nodiscard]] std::size_t rank(const Key& key) const noexcept;
+    [[nodiscard]] const value_type& select(std::size_t k) const;
+    [[nodiscard]] std::size_t count_in_range(const Key& lo, const Key& hi) const noexcept;
+
+    [[nodiscard]] const_iterator lower_bound(const Key& key) const;
+    [[nodiscard]] const_iterator upper_bound(const Key& key) const;
+    [[nodiscard]] Range range(const Key& lo, const Key& hi) const;
+
+private:
+    template <class, class, class, class>
+    friend class BasicAVL;
+
+    static constexpr std::size_t nodeKeys = 16;
+    static constexpr std::size_t fanout   = nodeKeys + 1;
+
+    // values must be sorted by key without duplicates
+    BasicFrozenAVL(std::vector<value_type> values, const Compare& comp);
+
+    // sorted values, for sets padded up to whole nodes with copies of the last one
+    std::vector<value_type> values;
+    // upper levels from the root down, for maps followed by the padded sorted keys
+    std::vector<Key> index;
+    // start of every upper level in index, root first
+    std::vector<std::size_t> levels;
+    std::size_t count{0};
+    Compare comp;
+
+    static const Key& keyOf(const value_type& value);
+
+    const Key* leafKeys() const;
+    const Key& lastKey() const;
+
+    // number of keys in the node less than (upper: not greater than) the given one
+    template <bool upper>
+    std::size_t countInNode(const Key* node, const Key& key) const;
+    // position of the first value whose key is not less (upper: greater) than the given one
+    template <bool upper>
+    std::size_t search(const Key& key) const;
+};
+
+using FrozenAVL = BasicFrozenAVL<int>;
+
+#include "tree/FrozenTree.ipp"
+
+extern template class BasicFrozenAVL<int>;
+
+#endif
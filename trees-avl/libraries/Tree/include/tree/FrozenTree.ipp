@@ -0,0 +1,178 @@
+// BasicFrozenAVL implementation, included from tree/FrozenTree.hpp
+
+template <class Key, class Mapped, class Compare>
+BasicFrozenAVL<Key, Mapped, Compare>::BasicFrozenAVL(const Compare& comp) : comp(comp) {}
+
+template <class Key, class Mapped, class Compare>
+BasicFrozenAVL<Key, Mapped, Compare>::BasicFrozenAVL(std::vector<value_type> sorted, const Compare& comp)
+    : values(std::move(sorted)), count(values.size()), comp(comp) {
+    if (count == 0) {
+        return;
+    }
+    const std::size_t leafNodes = (count + nodeKeys - 1) / nodeKeys;
+    const std::size_t padded    = leafNodes * nodeKeys;
+    const auto leafKey          = [this](std::size_t i) -> const Key& { return keyOf(values[std::min(i, count - 1)]); };
+
+    // node counts of the upper levels from the bottom up
+    std::vector<std::size_t> nodeCounts;
+    for (std::size_t below = leafNodes; below > 1;) {
+        below = (below + fanout - 1) / fanout;
+        nodeCounts.push_back(below);
+    }
+    std::size_t total = isMap ? padded : 0;
+    for (std::size_t nodes : nodeCounts) {
+        total += nodes * nodeKeys;
+    }
+    index.reserve(total);
+    levels.resize(nodeCounts.size());
+
+    // a node's separators are the smallest keys of its children but the first,
+    // children past the end are represented by the largest key so that nothing descends there
+    for (std::size_t level = 0; level < nodeCounts.size(); ++level) {
+        const std::size_t height = nodeCounts.size() - level;
+        std::size_t span         = 1;  // leaf nodes under one child
+        for (std::size_t h = 1; h < height; ++h) {
+            span *= fanout;
+        }
+        levels[level] = index.size();
+        for (std::size_t child = 1; child < nodeCounts[height - 1] * fanout; ++child) {
+            if (child % fanout == 0) {
+                continue;
+            }
+            const std::size_t leaf = child * span;
+            index.push_back(leaf < leafNodes ? leafKey(leaf * nodeKeys) : leafKey(count - 1));
+        }
+    }
+
+    if constexpr (isMap) {
+        for (std::size_t i = 0; i < padded; ++i) {
+            index.push_back(leafKey(i));
+        }
+    } else {
+        const value_type last = values.back();
+        values.resize(padded, last);
+    }
+}
+
+template <class Key, class Mapped, class Compare>
+bool BasicFrozenAVL<Key, Mapped, Compare>::contains(const Key& key) const noexcept {
+    const std::size_t i = search<false>(key);
+    return i < count && !comp(key, keyOf(values[i]));
+}
+
+template <class Key, class Mapped, class Compare>
+auto BasicFrozenAVL<Key, Mapped, Compare>::find(const Key& key) const -> const_iterator {
+    return contains(key) ? lower_bound(key) : end();
+}
+
+template <class Key, class Mapped, class Compare>
+std::size_t BasicFrozenAVL<Key, Mapped, Compare>::size() const noexcept {
+    return count;
+}
+
+template <class Key, class Mapped, class Compare>
+bool BasicFrozenAVL<Key, Mapped, Compare>::empty() const noexcept {
+    return count == 0;
+}
+
+template <class Key, class Mapped, class Compare>
+auto BasicFrozenAVL<Key, Mapped, Compare>::begin() const -> const_iterator {
+    return values.begin();
+}
+
+template <class Key, class Mapped, class Compare>
+auto BasicFrozenAVL<Key, Mapped, Compare>::end() const -> const_iterator {
+    return values.begin() + static_cast<std::ptrdiff_t>(count);
+}
+
+template <class Key, class Mapped, class Compare>
+std::size_t BasicFrozenAVL<Key, Mapped, Compare>::rank(const Key& key) const noexcept {
+    return search<false>(key);
+}
+
+template <class Key, class Mapped, class Compare>
+auto BasicFrozenAVL<Key, Mapped, Compare>::select(std::size_t k) const -> const value_type& {
+    if (k >= count) {
+        throw std::out_of_range("FrozenAVL::select: index out of range");
+    }
+    return values[k];
+}
+
+template <class Key, class Mapped, class Compare>
+std::size_t BasicFrozenAVL<Key, Mapped, Compare>::count_in_range(const Key& lo, const Key& hi) const noexcept {
+    if (comp(hi, lo)) {
+        return 0;
+    }
+    return search<true>(hi) - search<false>(lo);
+}
+
+template <class Key, class Mapped, class Compare>
+auto BasicFrozenAVL<Key, Mapped, Compare>::lower_bound(const Key& key) const -> const_iterator {
+    return begin() + static_cast<std::ptrdiff_t>(search<false>(key));
+}
+
+template <class Key, class Mapped, class Compare>
+auto BasicFrozenAVL<Key, Mapped, Compare>::upper_bound(const Key& key) const -> const_iterator {
+    return begin() + static_cast<std::ptrdiff_t>(search<true>(key));
+}
+
+template <class Key, class Mapped, class Compare>
+auto BasicFrozenAVL<Key, Mapped, Compare>::range(const Key& lo, const Key& hi) const -> Range {
+    if (comp(hi, lo)) {
+        return {end(), end()};
+    }
+    return {lower_bound(lo), upper_bound(hi)};
+}
+
+// private methods
+
+template <class Key, class Mapped, class Compare>
+const Key& BasicFrozenAVL<Key, Mapped, Compare>::keyOf(const value_type& value) {
+    if constexpr (isMap) {
+        return value.first;
+    } else {
+        return value;
+    }
+}
+
+template <class Key, class Mapped, class Compare>
+const Key* BasicFrozenAVL<Key, Mapped, Compare>::leafKeys() const {
+    if constexpr (isMap) {
+        return index.data() + index.size() - (count + nodeKeys - 1) / nodeKeys * nodeKeys;
+    } else {
+        return values.data();
+    }
+}
+
+template <class Key, class Mapped, class Compare>
+const Key& BasicFrozenAVL<Key, Mapped, Compare>::lastKey() const {
+    return keyOf(values[count - 1]);
+}
+
+template <class Key, class Mapped, class Compare>
+template <bool upper>
+std::size_t BasicFrozenAVL<Key, Mapped, Compare>::countInNode(const Key* node, const Key& key) const {
+    std::size_t result = 0;
+    for (std::size_t i = 0; i < nodeKeys; ++i) {
+        if constexpr (upper) {
+            result += !comp(key, node[i]);
+        } else {
+            result += comp(node[i], key);
+        }
+    }
+    return result;
+}
+
+template <class Key, class Mapped, class Compare>
+template <bool upper>
+std::size_t BasicFrozenAVL<Key, Mapped, Compare>::search(const Key& key) const {
+    // past the largest key there is nothing to find, below it the separators never lead past the end
+    if (count == 0 || (upper ? !comp(key, lastKey()) : comp(lastKey(), key))) {
+        return count;
+    }
+    std::size_t node = 0;
+    for (std::size_t start : levels) {
+        node = node * fanout + countInNode<upper>(index.data() + start + node * nodeKeys, key);
+    }
+    return node * nodeKeys + countInNode<upper>(leafKeys() + node * nodeKeys, key);
+}
@@ -0,0 +1,87 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fork-join pool for the recursive tree algorithms: invoke() runs two calls in parallel.
+// The calling thread takes part in the work, so a pool of n workers runs on n + 1 threads
+class ThreadPool {
+public:
+    // one worker per hardware thread besides the calling one
+    ThreadPool();
+    explicit ThreadPool(std::size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] std::size_t workers() const noexcept;
+
+    // runs left on the calling thread while right waits to be picked up by a worker,
+    // the caller runs queued tasks itself until right is done, so nested calls never deadlock.
+    // An exception thrown by either call is rethrown here once both have finished
+    template <class F, class G>
+    void invoke(F&& left, G&& right);
+
+private:
+    struct Task {
+        std::function<void()> run;
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+    };
+
+    void push(Task& task);
+    // runs a queued task, the newest one for a waiting caller and the oldest for a worker,
+    // returns false if the queue is empty
+    bool runOne(bool newest);
+    static void execute(Task& task);
+    void work();
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Task*> queue;
+    std::vector<std::thread> threads;
+    bool stopping{false};
+};
+
+template <class F, class G>
+void ThreadPool::invoke(F&& left, G&& right) {
+    if (threads.empty()) {
+        left();
+        right();
+        return;
+    }
+
+    Task task;
+    task.run = [&right] { right(); };
+    push(task);
+
+    std::exception_ptr error;
+    try {
+        left();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    while (!task.done.load(std::memory_order_acquire)) {
+        if (!runOne(true)) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (task.error) {
+        std::rethrow_exception(task.error);
+    }
+}
+
+#endif
@@ -1,62 +1,299 @@
 #ifndef TREE_HPP
 #define TREE_HPP
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-class AVL {
+#include "tree/FrozenTree.hpp"
+#include "tree/ThreadPool.hpp"
+
+// AVL tree over Key ordered by Compare. With Mapped = void it is a set of keys,
+// otherwise a map storing std::pair<Key, Mapped>. Values must be default constructible
+// (the "no node" sentinel holds one) and may be move-only.
+template <class Key, class Mapped = void, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+class BasicAVL {
+    using Index = std::uint32_t;
+
+    // AVL height never exceeds 1.44 * log2(2^32 nodes)
+    static constexpr std::size_t maxDepth = 48;
+
+    static constexpr bool isMap = !std::is_void_v<Mapped>;
+    // arithmetic keys under std::less get a lookup loop tuned for them
+    static constexpr bool naturalOrder =
+        std::is_arithmetic_v<Key> && (std::is_same_v<Compare, std::less<Key>> || std::is_same_v<Compare, std::less<>>);
+
 public:
-    [[nodiscard]] bool contains(int value) const noexcept;
-    bool insert(int value);
-    bool remove(int value);
+    using key_type    = Key;
+    using mapped_type = Mapped;
+    using value_type  = std::conditional_t<isMap, std::pair<Key, Mapped>, Key>;
+
+    // in-order iterator keeping the path from the root on a fixed-size stack,
+    // invalidated by any modification of the tree
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = BasicAVL::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const value_type*;
+        using reference         = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const;
+        pointer operator->() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+    private:
+        friend class BasicAVL;
+
+        const_iterator(const BasicAVL* tree);
+        void pushLeft(Index n);
+
+        const BasicAVL* tree{nullptr};
+        std::array<Index, maxDepth> path{};
+        std::size_t depth{0};
+    };
+
+    struct Range {
+        const_iterator first;
+        const_iterator last;
+
+        [[nodiscard]] const_iterator begin() const { return first; }
+        [[nodiscard]] const_iterator end() const { return last; }
+    };
+
+    explicit BasicAVL(const Compare& comp = Compare(), const Allocator& allocator = Allocator());
+
+    // read-only: lookups never write to the nodes, so any number of threads may
+    // run const methods concurrently as long as nobody modifies the tree (see ConcurrentAVL).
+    // Overloads taking K are available for transparent comparators (heterogeneous lookup)
+    [[nodiscard]] bool contains(const Key& key) const noexcept;
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    [[nodiscard]] bool contains(const K& key) const noexcept;
+
+    [[nodiscard]] const_iterator find(const Key& key) const;
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    [[nodiscard]] const_iterator find(const K& key) const;
+
+    // set insertion
+    template <class M = Mapped, class = std::enable_if_t<std::is_void_v<M>>>
+    bool insert(Key key);
+    // map insertion, both keep the existing value if the key is already present
+    template <class M = Mapped, class = std::enable_if_t<!std::is_void_v<M>>>
+    bool insert(Key key, M mapped);
+    template <class M = Mapped, class = std::enable_if_t<!std::is_void_v<M>>>
+    bool insert_or_assign(Key key, M mapped);
+
+    // map access, at throws std::out_of_range for absent keys
+    template <class M = Mapped, class = std::enable_if_t<!std::is_void_v<M>>>
+    M& operator[](const Key& key);
+    template <class M = Mapped, class = std::enable_if_t<!std::is_void_v<M>>>
+    M& at(const Key& key);
+    template <class M = Mapped, class = std::enable_if_t<!std::is_void_v<M>>>
+    const M& at(const Key& key) const;
+
+    bool remove(const Key& key);
 
     [[nodiscard]] std::size_t size() const noexcept;
     [[nodiscard]] bool empty() const noexcept;
 
-    [[nodiscard]] std::vector<int> values() const noexcept;
+    [[nodiscard]] std::vector<value_type> values() const;
+
+    [[nodiscard]] const_iterator begin() const;
+    [[nodiscard]] const_iterator end() const;
+
+    // order statistics in O(log n): rank is the number of keys less than the given one,
+    // select returns the k-th smallest value (0-based) and throws std::out_of_range if k >= size()
+    [[nodiscard]] std::size_t rank(const Key& key) const noexcept;
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    [[nodiscard]] std::size_t rank(const K& key) const noexcept;
+    [[nodiscard]] const value_type& select(std::size_t k) const;
+    // number of keys in [lo, hi]
+    [[nodiscard]] std::size_t count_in_range(const Key& lo, const Key& hi) const noexcept;
 
-    ~AVL();
+    // first value whose key is not less / greater than the given one
+    [[nodiscard]] const_iterator lower_bound(const Key& key) const;
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    [[nodiscard]] const_iterator lower_bound(const K& key) const;
+    [[nodiscard]] const_iterator upper_bound(const Key& key) const;
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    [[nodiscard]] const_iterator upper_bound(const K& key) const;
+    // lazy in-order view of the values with keys in [lo, hi]
+    [[nodiscard]] Range range(const Key& lo, const Key& hi) const;
+
+    // replaces the content with the given values in O(n) if they are sorted, O(n log n) otherwise
+    void build(std::vector<value_type> values);
+    // merges the values into the tree, rebuilding it in O(n + m) when that beats m inserts
+    void insert_range(std::vector<value_type> values);
+
+    // joins a tree whose keys are all greater than the ones here, throws std::invalid_argument otherwise.
+    // The nodes of the smaller tree move into the arena of the larger one: O(min(n, m) + log n)
+    void join(BasicAVL other);
+    // moves the keys not less than the given one into the returned tree in O(log n + smaller part)
+    BasicAVL split(const Key& key);
+
+    // set operations by split and join in O(m log(n / m + 1)) for sizes m <= n, unite also moves the
+    // smaller arena in O(m) and keeps the value of this tree for keys present in both.
+    // With a pool, subproblems of 2^14 keys and more run in parallel
+    void unite(BasicAVL other, ThreadPool* pool = nullptr);
+    void intersect(const BasicAVL& other, ThreadPool* pool = nullptr);
+    void subtract(const BasicAVL& other, ThreadPool* pool = nullptr);
+
+    // copies the values into an immutable structure answering lookups, rank and range queries
+    // several times faster, the tree itself stays as it is
+    [[nodiscard]] BasicFrozenAVL<Key, Mapped, Compare> freeze() const;
+
+    // drops every node at once (O(1) for trivially destructible values), the arena keeps its capacity
+    void clear() noexcept;
+    void reserve(std::size_t count);
 
 private:
+    // nodes live in one arena and link to each other by 32-bit indices,
+    // index 0 is a sentinel with zero height and size standing for "no node"
+    static constexpr Index nil = 0;
+
     struct Node {
-        int value;
+        value_type value;
         int height{1};
-        size_t size{1};
-        Node* left{nullptr};
-        Node* right{nullptr};
-        Node(int);
+        Index size{1};
+        Index left{nil};
+        Index right{nil};
+
+        template <class... Args>
+        explicit Node(Args&&... args) : value(std::forward<Args>(args)...) {}
+    };
+    static_assert(!std::is_same_v<value_type, int> || sizeof(Node) == 20, "AVL<int> node is expected to take 20 bytes");
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+
+    // ancestors of a modified position, bit d of `left` tells whether we went left from ancestors[d]
+    struct Path {
+        std::array<Index, maxDepth> ancestors;
+        std::uint64_t left{0};
+        std::size_t depth{0};
+
+        void push(Index n, bool toLeft) {
+            ancestors[depth] = n;
+            left |= std::uint64_t{toLeft} << depth++;
+        }
     };
 
-    Node* root{nullptr};
+    static constexpr std::size_t parallelGrain = 1 << 14;
+
+    std::vector<Node, NodeAllocator> nodes;
+    Index root{nil};
+    // removed nodes are chained through their left links
+    Index freeList{nil};
+    // whole subtrees dropped by the set operations, taken apart node by node when the free list runs out
+    std::vector<Index> garbage;
+    Compare comp;
 
-    static void destruct(Node* n);
+    static const Key& keyOf(const value_type& value);
 
-    static int getHeight(Node* n);
-    static size_t getSize(Node* n);
-    static int getBalance(Node* n);
+    template <class K>
+    bool less(const K& key, Index n) const;
+    template <class K>
+    bool greater(const K& key, Index n) const;
 
-    static void updateHeight(Node* n);
-    static void updateSize(Node* n);
-    static void update(Node* n);
+    Index allocate(value_type&& value);
+    void release(Index n);
 
-    static Node* leftRotate(Node* n);
-    static Node* rightRotate(Node* n);
+    int getHeight(Index n) const;
+    Index getSize(Index n) const;
+    int getBalance(Index n) const;
 
-    static Node* bigLeftRotate(Node* n);
-    static Node* bigRightRotate(Node* n);
+    void updateHeight(Index n);
+    void updateSize(Index n);
+    void update(Index n);
 
-    static Node* makeBalance(Node* n);
+    Index leftRotate(Index n);
+    Index rightRotate(Index n);
 
-    static Node* containsImpl(Node* n, int value);
+    Index bigLeftRotate(Index n);
+    Index bigRightRotate(Index n);
 
-    static Node* insertImpl(Node* n, int value);
+    Index makeBalance(Index n);
 
-    static Node* getMin(Node* n);
-    static Node* removeImpl(Node* n, int value);
+    template <class K>
+    Index containsImpl(const K& key) const;
+    template <class K>
+    std::size_t countLess(const K& key) const;
+    template <class K>
+    std::size_t countNotGreater(const K& key) const;
+    template <class K>
+    const_iterator lowerBoundImpl(const K& key) const;
+    template <class K>
+    const_iterator upperBoundImpl(const K& key) const;
 
-    static void valuesImpl(Node* n, std::vector<int>& result);
+    // returns the node holding the key or nil, filling the path down to it
+    Index findPath(const Key& key, Path& path) const;
+    // relinks child under the path and rebalances upwards until the heights settle,
+    // the sizes above that point only move by one
+    void retrace(Path& path, Index child, bool grown);
+
+    // both leave the nodes untouched when there is nothing to insert / remove,
+    // found is the node holding the key either way
+    bool insertImpl(value_type& value, Index& found);
+    bool removeImpl(const Key& key);
+
+    // join and split on subtrees of this arena, all keys in l are less than m's and all in r greater
+    Index joinImpl(Index l, Index m, Index r);
+    Index joinRight(Index l, Index m, Index r);
+    Index joinLeft(Index l, Index m, Index r);
+    Index join2(Index l, Index r);
+    // detach the smallest / largest node of a subtree
+    Index splitFirst(Index n, Index& first);
+    Index splitLast(Index n, Index& last);
+    void splitImpl(Index n, const Key& key, Index& l, Index& found, Index& r);
+
+    // moves the subtree of another arena here keeping its shape, returns its new root
+    Index adopt(BasicAVL& from, Index n);
+    void swapStorage(BasicAVL& other) noexcept;
+
+    // the recursive set operations never allocate, so tasks on disjoint subtrees may run in parallel;
+    // the nodes and subtrees they drop are collected in `dropped` and handed to discard() at the end
+    Index uniteImpl(Index a, Index b, bool keepA, std::vector<Index>& dropped, ThreadPool* pool);
+    Index intersectImpl(Index a, const BasicAVL& other, Index b, std::vector<Index>& dropped, ThreadPool* pool);
+    Index subtractImpl(Index a, const BasicAVL& other, Index b, std::vector<Index>& dropped, ThreadPool* pool);
+    void dropNode(Index n, std::vector<Index>& dropped);
+    void discard(const std::vector<Index>& dropped);
+    void releaseTree(Index n);
+    template <class Left, class Right>
+    static void fork(ThreadPool* pool, std::size_t work, std::vector<Index>& dropped, Left&& left, Right&& right);
+
+    void valuesImpl(Index n, std::vector<value_type>& result) const;
+    // moves the values out, leaving the tree to be rebuilt
+    void extractImpl(Index n, std::vector<value_type>& result);
+
+    void prepareRange(std::vector<value_type>& values) const;
+    Index buildImpl(Index first, Index count);
 };
 
+using AVL = BasicAVL<int>;
+
+template <class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+using AVLSet = BasicAVL<Key, void, Compare, Allocator>;
+
+template <class Key, class Mapped, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+using AVLMap = BasicAVL<Key, Mapped, Compare, Allocator>;
+
+#include "tree/Tree.ipp"
+
+extern template class BasicAVL<int>;
+
 #endif
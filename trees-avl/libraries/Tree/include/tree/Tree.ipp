@@ -0,0 +1,1013 @@
+// BasicAVL implementation, included from tree/Tree.hpp
+
+template <class Key, class Mapped, class Compare, class Allocator>
+BasicAVL<Key, Mapped, Compare, Allocator>::BasicAVL(const Compare& comp, const Allocator& allocator)
+    : nodes(NodeAllocator(allocator)), comp(comp) {
+    nodes.emplace_back();
+    nodes[nil].height = 0;
+    nodes[nil].size   = 0;
+}
+
+// public methods
+
+template <class Key, class Mapped, class Compare, class Allocator>
+std::size_t BasicAVL<Key, Mapped, Compare, Allocator>::size() const noexcept {
+    return getSize(root);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::empty() const noexcept {
+    return size() == 0;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class M, class>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::insert(Key key) {
+    value_type value(std::move(key));
+    Index found = nil;
+    return insertImpl(value, found);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class M, class>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::insert(Key key, M mapped) {
+    value_type value(std::move(key), std::move(mapped));
+    Index found = nil;
+    return insertImpl(value, found);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class M, class>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::insert_or_assign(Key key, M mapped) {
+    value_type value(std::move(key), std::move(mapped));
+    Index found = nil;
+    if (insertImpl(value, found)) {
+        return true;
+    }
+    nodes[found].value.second = std::move(value.second);
+    return false;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class M, class>
+M& BasicAVL<Key, Mapped, Compare, Allocator>::operator[](const Key& key) {
+    Index found = containsImpl(key);
+    if (found == nil) {
+        value_type value(key, M());
+        insertImpl(value, found);
+    }
+    return nodes[found].value.second;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class M, class>
+M& BasicAVL<Key, Mapped, Compare, Allocator>::at(const Key& key) {
+    const Index found = containsImpl(key);
+    if (found == nil) {
+        throw std::out_of_range("AVL::at: key not found");
+    }
+    return nodes[found].value.second;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class M, class>
+const M& BasicAVL<Key, Mapped, Compare, Allocator>::at(const Key& key) const {
+    const Index found = containsImpl(key);
+    if (found == nil) {
+        throw std::out_of_range("AVL::at: key not found");
+    }
+    return nodes[found].value.second;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::remove(const Key& key) {
+    return removeImpl(key);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::contains(const Key& key) const noexcept {
+    return containsImpl(key) != nil;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K, class C, class>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::contains(const K& key) const noexcept {
+    return containsImpl(key) != nil;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::find(const Key& key) const -> const_iterator {
+    const_iterator it = lowerBoundImpl(key);
+    return it != end() && !less(key, it.path[it.depth - 1]) ? it : end();
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K, class C, class>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::find(const K& key) const -> const_iterator {
+    const_iterator it = lowerBoundImpl(key);
+    return it != end() && !less(key, it.path[it.depth - 1]) ? it : end();
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::values() const -> std::vector<value_type> {
+    std::vector<value_type> result;
+    result.reserve(size());
+    valuesImpl(root, result);
+    return result;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::begin() const -> const_iterator {
+    const_iterator it(this);
+    it.pushLeft(root);
+    return it;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::end() const -> const_iterator {
+    return const_iterator(this);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+std::size_t BasicAVL<Key, Mapped, Compare, Allocator>::rank(const Key& key) const noexcept {
+    return countLess(key);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K, class C, class>
+std::size_t BasicAVL<Key, Mapped, Compare, Allocator>::rank(const K& key) const noexcept {
+    return countLess(key);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::select(std::size_t k) const -> const value_type& {
+    if (k >= size()) {
+        throw std::out_of_range("AVL::select: index out of range");
+    }
+    Index n = root;
+    for (;;) {
+        const std::size_t left = getSize(nodes[n].left);
+        if (k < left) {
+            n = nodes[n].left;
+        } else if (k > left) {
+            k -= left + 1;
+            n = nodes[n].right;
+        } else {
+            return nodes[n].value;
+        }
+    }
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+std::size_t BasicAVL<Key, Mapped, Compare, Allocator>::count_in_range(const Key& lo, const Key& hi) const noexcept {
+    if (comp(hi, lo)) {
+        return 0;
+    }
+    return countNotGreater(hi) - countLess(lo);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::lower_bound(const Key& key) const -> const_iterator {
+    return lowerBoundImpl(key);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K, class C, class>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::lower_bound(const K& key) const -> const_iterator {
+    return lowerBoundImpl(key);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::upper_bound(const Key& key) const -> const_iterator {
+    return upperBoundImpl(key);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K, class C, class>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::upper_bound(const K& key) const -> const_iterator {
+    return upperBoundImpl(key);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::range(const Key& lo, const Key& hi) const -> Range {
+    if (comp(hi, lo)) {
+        return {end(), end()};
+    }
+    return {lowerBoundImpl(lo), upperBoundImpl(hi)};
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::build(std::vector<value_type> values) {
+    prepareRange(values);
+    clear();
+    reserve(values.size());
+    for (value_type& value : values) {
+        nodes.emplace_back(std::move(value));
+    }
+    // nodes 1..n are in sorted order now
+    root = buildImpl(1, static_cast<Index>(values.size()));
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::insert_range(std::vector<value_type> values) {
+    prepareRange(values);
+    const size_t n = size();
+    const size_t m = values.size();
+    if (m == 0) {
+        return;
+    }
+    // m inserts cost m log n, a rebuild costs n + m
+    if (n > 0 && m * static_cast<size_t>(std::log2(n) + 1) < n) {
+        for (value_type& value : values) {
+            Index found = nil;
+            insertImpl(value, found);
+        }
+        return;
+    }
+
+    std::vector<value_type> old;
+    old.reserve(n);
+    extractImpl(root, old);
+    std::vector<value_type> merged;
+    merged.reserve(n + m);
+    auto it = old.begin();
+    for (value_type& value : values) {
+        while (it != old.end() && comp(keyOf(*it), keyOf(value))) {
+            merged.push_back(std::move(*it++));
+        }
+        if (it != old.end() && !comp(keyOf(value), keyOf(*it))) {
+            continue;
+        }
+        merged.push_back(std::move(value));
+    }
+    std::move(it, old.end(), std::back_inserter(merged));
+    build(std::move(merged));
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::join(BasicAVL other) {
+    if (other.empty()) {
+        return;
+    }
+    if (empty()) {
+        swapStorage(other);
+        return;
+    }
+    if (!comp(keyOf(select(size() - 1)), keyOf(other.select(0)))) {
+        throw std::invalid_argument("AVL::join: keys of the joined tree must be greater");
+    }
+
+    const bool swapped = other.size() > size();
+    if (swapped) {
+        swapStorage(other);
+    }
+    const Index adopted = adopt(other, other.root);
+    const Index l       = swapped ? adopted : root;
+    Index r             = swapped ? root : adopted;
+    Index first         = nil;
+    r                   = splitFirst(r, first);
+    root                = joinImpl(l, first, r);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::split(const Key& key) -> BasicAVL {
+    Index l     = nil;
+    Index found = nil;
+    Index r     = nil;
+    splitImpl(root, key, l, found, r);
+    if (found != nil) {
+        r = joinImpl(nil, found, r);
+    }
+
+    // the larger part stays in this arena, the smaller one is moved out
+    const bool rightIsSmaller = getSize(r) <= getSize(l);
+    const Index moved         = rightIsSmaller ? r : l;
+    BasicAVL result(comp, nodes.get_allocator());
+    result.reserve(getSize(moved));
+    if (moved != nil) {
+        result.root = result.adopt(*this, moved);
+        discard({moved});
+    }
+    root = rightIsSmaller ? l : r;
+    if (!rightIsSmaller) {
+        swapStorage(result);
+    }
+    return result;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::unite(BasicAVL other, ThreadPool* pool) {
+    if (other.empty()) {
+        return;
+    }
+    // split the larger tree by the keys of the smaller one
+    const bool keepThis = other.size() <= size();
+    if (!keepThis) {
+        swapStorage(other);
+    }
+    const Index b = adopt(other, other.root);
+    std::vector<Index> dropped;
+    root = uniteImpl(root, b, keepThis, dropped, pool);
+    discard(dropped);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::intersect(const BasicAVL& other, ThreadPool* pool) {
+    if (&other == this) {
+        return;
+    }
+    std::vector<Index> dropped;
+    root = intersectImpl(root, other, other.root, dropped, pool);
+    discard(dropped);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::subtract(const BasicAVL& other, ThreadPool* pool) {
+    if (&other == this) {
+        clear();
+        return;
+    }
+    std::vector<Index> dropped;
+    root = subtractImpl(root, other, other.root, dropped, pool);
+    discard(dropped);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::freeze() const -> BasicFrozenAVL<Key, Mapped, Compare> {
+    return BasicFrozenAVL<Key, Mapped, Compare>(values(), comp);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::clear() noexcept {
+    nodes.erase(nodes.begin() + 1, nodes.end());
+    root     = nil;
+    freeList = nil;
+    garbage.clear();
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::reserve(std::size_t count) {
+    nodes.reserve(count + 1);
+}
+
+// private methods
+
+template <class Key, class Mapped, class Compare, class Allocator>
+const Key& BasicAVL<Key, Mapped, Compare, Allocator>::keyOf(const value_type& value) {
+    if constexpr (isMap) {
+        return value.first;
+    } else {
+        return value;
+    }
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::less(const K& key, Index n) const {
+    return comp(key, keyOf(nodes[n].value));
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::greater(const K& key, Index n) const {
+    return comp(keyOf(nodes[n].value), key);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::allocate(value_type&& value) -> Index {
+    if (freeList == nil && !garbage.empty()) {
+        const Index n = garbage.back();
+        garbage.pop_back();
+        for (Index child : {nodes[n].left, nodes[n].right}) {
+            if (child != nil) {
+                garbage.push_back(child);
+            }
+        }
+        nodes[n].left = nil;
+        freeList      = n;
+    }
+    if (freeList != nil) {
+        Index n     = freeList;
+        Node& node  = nodes[n];
+        freeList    = node.left;
+        node.value  = std::move(value);
+        node.height = 1;
+        node.size   = 1;
+        node.left   = nil;
+        node.right  = nil;
+        return n;
+    }
+    nodes.emplace_back(std::move(value));
+    return static_cast<Index>(nodes.size() - 1);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::release(Index n) {
+    // free the resources of a removed value now rather than on reuse
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+        nodes[n].value = value_type();
+    }
+    nodes[n].left = freeList;
+    freeList      = n;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+int BasicAVL<Key, Mapped, Compare, Allocator>::getHeight(Index n) const {
+    return nodes[n].height;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::getSize(Index n) const -> Index {
+    return nodes[n].size;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::updateHeight(Index n) {
+    nodes[n].height = std::max(getHeight(nodes[n].left), getHeight(nodes[n].right)) + 1;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::updateSize(Index n) {
+    nodes[n].size = getSize(nodes[n].left) + getSize(nodes[n].right) + 1;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::update(Index n) {
+    updateHeight(n);
+    updateSize(n);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+int BasicAVL<Key, Mapped, Compare, Allocator>::getBalance(Index n) const {
+    return getHeight(nodes[n].right) - getHeight(nodes[n].left);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::rightRotate(Index n) -> Index {
+    Index left        = nodes[n].left;
+    nodes[n].left     = nodes[left].right;
+    nodes[left].right = n;
+
+    update(n);
+    update(left);
+
+    return left;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::leftRotate(Index n) -> Index {
+    Index right       = nodes[n].right;
+    nodes[n].right    = nodes[right].left;
+    nodes[right].left = n;
+
+    update(n);
+    update(right);
+
+    return right;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::bigLeftRotate(Index n) -> Index {
+    nodes[n].right = rightRotate(nodes[n].right);
+    return leftRotate(n);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::bigRightRotate(Index n) -> Index {
+    nodes[n].left = leftRotate(nodes[n].left);
+    return rightRotate(n);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::makeBalance(Index n) -> Index {
+    update(n);
+    int balance = getBalance(n);
+    if (balance == 2) {
+        if (getBalance(nodes[n].right) < 0) {
+            return bigLeftRotate(n);
+        } else {
+            return leftRotate(n);
+        }
+    } else if (balance == -2) {
+        if (getBalance(nodes[n].left) > 0) {
+            return bigRightRotate(n);
+        } else {
+            return rightRotate(n);
+        }
+    } else {
+        return n;
+    }
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::containsImpl(const K& key) const -> Index {
+    Index n = root;
+    if constexpr (naturalOrder) {
+        // the same order written with != so that the compiler emits one compare and a select per level
+        while (n != nil && keyOf(nodes[n].value) != key) {
+            n = key < keyOf(nodes[n].value) ? nodes[n].left : nodes[n].right;
+        }
+        return n;
+    }
+    while (n != nil) {
+        if (less(key, n)) {
+            n = nodes[n].left;
+        } else if (greater(key, n)) {
+            n = nodes[n].right;
+        } else {
+            return n;
+        }
+    }
+    return nil;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K>
+std::size_t BasicAVL<Key, Mapped, Compare, Allocator>::countLess(const K& key) const {
+    std::size_t result = 0;
+    Index n            = root;
+    while (n != nil) {
+        if (!greater(key, n)) {
+            n = nodes[n].left;
+        } else {
+            result += getSize(nodes[n].left) + 1;
+            n = nodes[n].right;
+        }
+    }
+    return result;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K>
+std::size_t BasicAVL<Key, Mapped, Compare, Allocator>::countNotGreater(const K& key) const {
+    std::size_t result = 0;
+    Index n            = root;
+    while (n != nil) {
+        if (less(key, n)) {
+            n = nodes[n].left;
+        } else {
+            result += getSize(nodes[n].left) + 1;
+            n = nodes[n].right;
+        }
+    }
+    return result;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::lowerBoundImpl(const K& key) const -> const_iterator {
+    const_iterator it(this);
+    Index n = root;
+    while (n != nil) {
+        if (!greater(key, n)) {
+            it.path[it.depth++] = n;
+            n                   = nodes[n].left;
+        } else {
+            n = nodes[n].right;
+        }
+    }
+    return it;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class K>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::upperBoundImpl(const K& key) const -> const_iterator {
+    const_iterator it(this);
+    Index n = root;
+    while (n != nil) {
+        if (less(key, n)) {
+            it.path[it.depth++] = n;
+            n                   = nodes[n].left;
+        } else {
+            n = nodes[n].right;
+        }
+    }
+    return it;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::findPath(const Key& key, Path& path) const -> Index {
+    Index n = root;
+    if constexpr (naturalOrder) {
+        while (n != nil && keyOf(nodes[n].value) != key) {
+            const bool toLeft = key < keyOf(nodes[n].value);
+            path.push(n, toLeft);
+            n = toLeft ? nodes[n].left : nodes[n].right;
+        }
+        return n;
+    }
+    while (n != nil) {
+        if (less(key, n)) {
+            path.push(n, true);
+            n = nodes[n].left;
+        } else if (greater(key, n)) {
+            path.push(n, false);
+            n = nodes[n].right;
+        } else {
+            return n;
+        }
+    }
+    return nil;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::retrace(Path& path, Index child, bool grown) {
+    bool heightChanged = true;
+    while (path.depth > 0) {
+        const Index n = path.ancestors[--path.depth];
+        if (path.left >> path.depth & 1) {
+            nodes[n].left = child;
+        } else {
+            nodes[n].right = child;
+        }
+
+        if (heightChanged) {
+            const int height = nodes[n].height;
+            child            = makeBalance(n);
+            heightChanged    = nodes[child].height != height;
+        } else {
+            nodes[n].size = grown ? nodes[n].size + 1 : nodes[n].size - 1;
+            child         = n;
+        }
+    }
+    root = child;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::insertImpl(value_type& value, Index& found) {
+    Path path;
+    found = findPath(keyOf(value), path);
+    if (found != nil) {
+        return false;
+    }
+    // allocate may grow the arena, nothing holds a node reference across it
+    found = allocate(std::move(value));
+    retrace(path, found, true);
+    return true;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::removeImpl(const Key& key) {
+    Path path;
+    const Index n = findPath(key, path);
+    if (n == nil) {
+        return false;
+    }
+
+    const Index l = nodes[n].left;
+    const Index r = nodes[n].right;
+    Index child   = l;
+    if (r != nil) {
+        // the successor node takes the removed node's place, values are never copied;
+        // its old right link is fixed up by retrace when min is the right child itself
+        const std::size_t slot = path.depth;
+        path.push(n, false);
+        Index min = r;
+        while (nodes[min].left != nil) {
+            path.push(min, true);
+            min = nodes[min].left;
+        }
+        child                = nodes[min].right;
+        nodes[min].left      = l;
+        nodes[min].right     = r;
+        nodes[min].height    = nodes[n].height;
+        nodes[min].size      = nodes[n].size;
+        path.ancestors[slot] = min;
+    }
+    release(n);
+    retrace(path, child, false);
+    return true;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::joinImpl(Index l, Index m, Index r) -> Index {
+    if (getHeight(l) > getHeight(r) + 1) {
+        return joinRight(l, m, r);
+    }
+    if (getHeight(r) > getHeight(l) + 1) {
+        return joinLeft(l, m, r);
+    }
+    nodes[m].left  = l;
+    nodes[m].right = r;
+    update(m);
+    return m;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::joinRight(Index l, Index m, Index r) -> Index {
+    // go down the right spine of the taller tree to a subtree of about r's height
+    if (getHeight(l) <= getHeight(r) + 1) {
+        nodes[m].left  = l;
+        nodes[m].right = r;
+        update(m);
+        return m;
+    }
+    nodes[l].right = joinRight(nodes[l].right, m, r);
+    return makeBalance(l);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::joinLeft(Index l, Index m, Index r) -> Index {
+    if (getHeight(r) <= getHeight(l) + 1) {
+        nodes[m].left  = l;
+        nodes[m].right = r;
+        update(m);
+        return m;
+    }
+    nodes[r].left = joinLeft(l, m, nodes[r].left);
+    return makeBalance(r);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::join2(Index l, Index r) -> Index {
+    if (l == nil) {
+        return r;
+    }
+    Index last = nil;
+    l          = splitLast(l, last);
+    return joinImpl(l, last, r);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::splitFirst(Index n, Index& first) -> Index {
+    if (nodes[n].left == nil) {
+        first = n;
+        return nodes[n].right;
+    }
+    nodes[n].left = splitFirst(nodes[n].left, first);
+    return makeBalance(n);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::splitLast(Index n, Index& last) -> Index {
+    if (nodes[n].right == nil) {
+        last = n;
+        return nodes[n].left;
+    }
+    nodes[n].right = splitLast(nodes[n].right, last);
+    return makeBalance(n);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::splitImpl(Index n, const Key& key, Index& l, Index& found, Index& r) {
+    if (n == nil) {
+        l     = nil;
+        found = nil;
+        r     = nil;
+        return;
+    }
+    const Index left  = nodes[n].left;
+    const Index right = nodes[n].right;
+    if (less(key, n)) {
+        Index rl = nil;
+        splitImpl(left, key, l, found, rl);
+        r = joinImpl(rl, n, right);
+    } else if (greater(key, n)) {
+        Index lr = nil;
+        splitImpl(right, key, lr, found, r);
+        l = joinImpl(left, n, lr);
+    } else {
+        l     = left;
+        found = n;
+        r     = right;
+    }
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::adopt(BasicAVL& from, Index n) -> Index {
+    if (n == nil) {
+        return nil;
+    }
+    const Index l   = adopt(from, from.nodes[n].left);
+    const Index r   = adopt(from, from.nodes[n].right);
+    const Index m   = allocate(std::move(from.nodes[n].value));
+    nodes[m].left   = l;
+    nodes[m].right  = r;
+    nodes[m].height = from.nodes[n].height;
+    nodes[m].size   = from.nodes[n].size;
+    return m;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::swapStorage(BasicAVL& other) noexcept {
+    std::swap(nodes, other.nodes);
+    std::swap(root, other.root);
+    std::swap(freeList, other.freeList);
+    std::swap(garbage, other.garbage);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::uniteImpl(Index a, Index b, bool keepA, std::vector<Index>& dropped, ThreadPool* pool) -> Index {
+    if (a == nil) {
+        return b;
+    }
+    if (b == nil) {
+        return a;
+    }
+    const std::size_t work = getSize(a) + getSize(b);
+    const Index bl         = nodes[b].left;
+    const Index br         = nodes[b].right;
+    Index l                = nil;
+    Index found            = nil;
+    Index r                = nil;
+    splitImpl(a, keyOf(nodes[b].value), l, found, r);
+    Index pivot = b;
+    if (found != nil) {
+        pivot = keepA ? found : b;
+        dropNode(keepA ? b : found, dropped);
+    }
+
+    Index left  = nil;
+    Index right = nil;
+    fork(
+        pool, work, dropped, [&](std::vector<Index>& d) { left = uniteImpl(l, bl, keepA, d, pool); },
+        [&](std::vector<Index>& d) { right = uniteImpl(r, br, keepA, d, pool); });
+    return joinImpl(left, pivot, right);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::intersectImpl(Index a, const BasicAVL& other, Index b, std::vector<Index>& dropped, ThreadPool* pool)
+    -> Index {
+    if (a == nil) {
+        return nil;
+    }
+    if (b == nil) {
+        dropped.push_back(a);
+        return nil;
+    }
+    const std::size_t work = getSize(a) + other.getSize(b);
+    Index l                = nil;
+    Index found            = nil;
+    Index r                = nil;
+    splitImpl(a, keyOf(other.nodes[b].value), l, found, r);
+
+    Index left  = nil;
+    Index right = nil;
+    fork(
+        pool, work, dropped,
+        [&](std::vector<Index>& d) { left = intersectImpl(l, other, other.nodes[b].left, d, pool); },
+        [&](std::vector<Index>& d) { right = intersectImpl(r, other, other.nodes[b].right, d, pool); });
+    return found != nil ? joinImpl(left, found, right) : join2(left, right);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::subtractImpl(Index a, const BasicAVL& other, Index b, std::vector<Index>& dropped, ThreadPool* pool)
+    -> Index {
+    if (a == nil || b == nil) {
+        return a;
+    }
+    const std::size_t work = getSize(a) + other.getSize(b);
+    Index l                = nil;
+    Index found            = nil;
+    Index r                = nil;
+    splitImpl(a, keyOf(other.nodes[b].value), l, found, r);
+    if (found != nil) {
+        dropNode(found, dropped);
+    }
+
+    Index left  = nil;
+    Index right = nil;
+    fork(
+        pool, work, dropped,
+        [&](std::vector<Index>& d) { left = subtractImpl(l, other, other.nodes[b].left, d, pool); },
+        [&](std::vector<Index>& d) { right = subtractImpl(r, other, other.nodes[b].right, d, pool); });
+    return join2(left, right);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::dropNode(Index n, std::vector<Index>& dropped) {
+    nodes[n].left  = nil;
+    nodes[n].right = nil;
+    dropped.push_back(n);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::discard(const std::vector<Index>& dropped) {
+    // values holding resources are freed right away as in release, plain ones wait in the garbage
+    if constexpr (std::is_trivially_destructible_v<value_type>) {
+        garbage.insert(garbage.end(), dropped.begin(), dropped.end());
+    } else {
+        for (Index n : dropped) {
+            releaseTree(n);
+        }
+    }
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::releaseTree(Index n) {
+    if (n == nil) {
+        return;
+    }
+    const Index l = nodes[n].left;
+    const Index r = nodes[n].right;
+    release(n);
+    releaseTree(l);
+    releaseTree(r);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+template <class Left, class Right>
+void BasicAVL<Key, Mapped, Compare, Allocator>::fork(ThreadPool* pool, std::size_t work, std::vector<Index>& dropped, Left&& left, Right&& right) {
+    if (pool == nullptr || work < parallelGrain) {
+        left(dropped);
+        right(dropped);
+        return;
+    }
+    std::vector<Index> rightDropped;
+    pool->invoke([&] { left(dropped); }, [&] { right(rightDropped); });
+    dropped.insert(dropped.end(), rightDropped.begin(), rightDropped.end());
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::valuesImpl(Index n, std::vector<value_type>& result) const {
+    if (n == nil) {
+        return;
+    }
+    valuesImpl(nodes[n].left, result);
+    result.push_back(nodes[n].value);
+    valuesImpl(nodes[n].right, result);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::extractImpl(Index n, std::vector<value_type>& result) {
+    if (n == nil) {
+        return;
+    }
+    extractImpl(nodes[n].left, result);
+    result.push_back(std::move(nodes[n].value));
+    extractImpl(nodes[n].right, result);
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::prepareRange(std::vector<value_type>& values) const {
+    const auto byKey = [this](const value_type& a, const value_type& b) { return comp(keyOf(a), keyOf(b)); };
+    if (!std::is_sorted(values.begin(), values.end(), byKey)) {
+        std::stable_sort(values.begin(), values.end(), byKey);
+    }
+    const auto equivalent = [&byKey](const value_type& a, const value_type& b) { return !byKey(a, b); };
+    values.erase(std::unique(values.begin(), values.end(), equivalent), values.end());
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::buildImpl(Index first, Index count) -> Index {
+    if (count == 0) {
+        return nil;
+    }
+    const Index mid  = first + count / 2;
+    nodes[mid].left  = buildImpl(first, count / 2);
+    nodes[mid].right = buildImpl(mid + 1, count - count / 2 - 1);
+    update(mid);
+    return mid;
+}
+
+// iterator
+
+template <class Key, class Mapped, class Compare, class Allocator>
+BasicAVL<Key, Mapped, Compare, Allocator>::const_iterator::const_iterator(const BasicAVL* tree) : tree(tree) {}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+void BasicAVL<Key, Mapped, Compare, Allocator>::const_iterator::pushLeft(Index n) {
+    while (n != nil) {
+        path[depth++] = n;
+        n             = tree->nodes[n].left;
+    }
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::const_iterator::operator*() const -> reference {
+    return tree->nodes[path[depth - 1]].value;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::const_iterator::operator->() const -> pointer {
+    return &**this;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::const_iterator::operator++() -> const_iterator& {
+    // the path keeps only the ancestors we went left from, so the one below the top is the successor
+    const Index right = tree->nodes[path[--depth]].right;
+    pushLeft(right);
+    return *this;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+auto BasicAVL<Key, Mapped, Compare, Allocator>::const_iterator::operator++(int) -> const_iterator {
+    const_iterator old = *this;
+    ++*this;
+    return old;
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::const_iterator::operator==(const const_iterator& other) const {
+    if (depth == 0 || other.depth == 0) {
+        return depth == other.depth;
+    }
+    return path[depth - 1] == other.path[other.depth - 1];
+}
+
+template <class Key, class Mapped, class Compare, class Allocator>
+bool BasicAVL<Key, Mapped, Compare, Allocator>::const_iterator::operator!=(const const_iterator& other) const {
+    return !(*this == other);
+}
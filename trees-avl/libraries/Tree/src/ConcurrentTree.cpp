@@ -0,0 +1,48 @@
+#include "tree/ConcurrentTree.hpp"
+
+#include <mutex>
+
+bool ConcurrentAVL::contains(int value) const {
+    std::shared_lock lock(mutex);
+    return tree.contains(value);
+}
+
+bool ConcurrentAVL::insert(int value) {
+    std::unique_lock lock(mutex);
+    return tree.insert(value);
+}
+
+bool ConcurrentAVL::remove(int value) {
+    std::unique_lock lock(mutex);
+    return tree.remove(value);
+}
+
+std::size_t ConcurrentAVL::size() const {
+    std::shared_lock lock(mutex);
+    return tree.size();
+}
+
+bool ConcurrentAVL::empty() const {
+    std::shared_lock lock(mutex);
+    return tree.empty();
+}
+
+std::vector<int> ConcurrentAVL::values() const {
+    std::shared_lock lock(mutex);
+    return tree.values();
+}
+
+void ConcurrentAVL::build(std::vector<int> values) {
+    std::unique_lock lock(mutex);
+    tree.build(std::move(values));
+}
+
+void ConcurrentAVL::insert_range(std::vector<int> values) {
+    std::unique_lock lock(mutex);
+    tree.insert_range(std::move(values));
+}
+
+void ConcurrentAVL::clear() {
+    std::unique_lock lock(mutex);
+    tree.clear();
+}
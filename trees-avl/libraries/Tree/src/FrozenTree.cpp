@@ -0,0 +1,4 @@
+#include "tree/FrozenTree.hpp"
+
+// the frozen int set is compiled once here, other instantiations are generated from tree/FrozenTree.ipp
+template class BasicFrozenAVL<int>;
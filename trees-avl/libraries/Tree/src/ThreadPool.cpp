@@ -0,0 +1,81 @@
+#include "tree/ThreadPool.hpp"
+
+#include <algorithm>
+
+// hardware_concurrency() may report 0
+ThreadPool::ThreadPool() : ThreadPool(std::max(1u, std::thread::hardware_concurrency()) - 1) {}
+
+ThreadPool::ThreadPool(std::size_t workers) {
+    threads.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        threads.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::workers() const noexcept {
+    return threads.size();
+}
+
+void ThreadPool::push(Task& task) {
+    {
+        std::lock_guard lock(mutex);
+        queue.push_back(&task);
+    }
+    ready.notify_one();
+}
+
+bool ThreadPool::runOne(bool newest) {
+    Task* task = nullptr;
+    {
+        std::lock_guard lock(mutex);
+        if (queue.empty()) {
+            return false;
+        }
+        if (newest) {
+            task = queue.back();
+            queue.pop_back();
+        } else {
+            task = queue.front();
+            queue.pop_front();
+        }
+    }
+    execute(*task);
+    return true;
+}
+
+void ThreadPool::execute(Task& task) {
+    try {
+        task.run();
+    } catch (...) {
+        task.error = std::current_exception();
+    }
+    task.done.store(true, std::memory_order_release);
+}
+
+void ThreadPool::work() {
+    for (;;) {
+        Task* task = nullptr;
+        {
+            std::unique_lock lock(mutex);
+            ready.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            // the oldest task is the largest subproblem
+            task = queue.front();
+            queue.pop_front();
+        }
+        execute(*task);
+    }
+}